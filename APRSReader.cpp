@@ -23,9 +23,11 @@
 #include "Log.h"
 
 #include <cstdio>
+#include <cassert>
 #include <cstdlib>
 #include <cstring>
 #include <cctype>
+#include <vector>
 #include <time.h>
 
 #if defined(_WIN32) || defined(_WIN64)
@@ -52,26 +54,147 @@ int gettimeofday(struct timeval * tp, struct timezone * tzp)
 
 const unsigned int APRS_TIMEOUT = 10U;
 
-CAPRSReader::CAPRSReader(std::string ApiKey,int refres_time) :
+// aprs.fi takes up to 20 names in one request, each callsign uses six
+const unsigned int APRS_BATCH = 3U;
+
+// Lookups in flight or waiting to be picked up, which bounds both queues
+const unsigned int APRS_QUEUE = 64U;
+
+// A connection unused for this long is closed before the server does it
+const unsigned int APRS_IDLE_TIME = 30000U;
+
+static const char* APRS_SUFFIXES[] = {"-Y", "-7", "-8", "-9", "-14", ""};
+const unsigned int APRS_SUFFIX_COUNT = 6U;
+
+// One station in the reply to a lookup
+class CAPRSEntry {
+public:
+	CAPRSEntry() :
+	m_name(),
+	m_latitude(),
+	m_longitude(),
+	m_time(0UL)
+	{
+	}
+
+	std::string   m_name;
+	std::string   m_latitude;
+	std::string   m_longitude;
+	unsigned long m_time;
+};
+
+// Picks the stations out of a reply as it is read, which has the shape
+// {"result":"ok","entries":[{"name":"..","lat":"..","lng":"..",...},...]}
+class CAPRSResponse : public CJSONParser {
+public:
+	CAPRSResponse() :
+	CJSONParser(),
+	m_result(),
+	m_description(),
+	m_entries(),
+	m_topKey(),
+	m_key(),
+	m_entry()
+	{
+	}
+
+	std::string             m_result;
+	std::string             m_description;
+	std::vector<CAPRSEntry> m_entries;
+
+protected:
+	virtual void onKey(const std::string& key)
+	{
+		if (getDepth() == 1U)
+			m_topKey = key;
+
+		m_key = key;
+	}
+
+	virtual void onStartObject()
+	{
+		if (isEntry())
+			m_entry = CAPRSEntry();
+	}
+
+	virtual void onEndObject()
+	{
+		if (isEntry())
+			m_entries.push_back(m_entry);
+	}
+
+	virtual void onValue(JSON_TYPE, const std::string& value)
+	{
+		if (getDepth() == 1U) {
+			if (m_key == "result")
+				m_result = value;
+			else if (m_key == "description")
+				m_description = value;
+		} else if (isEntry()) {
+			if (m_key == "name")
+				m_entry.m_name = value;
+			else if (m_key == "lat")
+				m_entry.m_latitude = value;
+			else if (m_key == "lng")
+				m_entry.m_longitude = value;
+			else if (m_key == "lasttime" || (m_key == "time" && m_entry.m_time == 0UL))
+				m_entry.m_time = ::strtoul(value.c_str(), NULL, 10);
+		}
+	}
+
+private:
+	std::string m_topKey;
+	std::string m_key;
+	CAPRSEntry  m_entry;
+
+	bool isEntry() const
+	{
+		return getDepth() == 3U && m_topKey == "entries";
+	}
+};
+
+static bool sameCallsign(const std::string& a, const char* b)
+{
+	unsigned int i = 0U;
+	for (; i < a.length() && b[i] != 0; i++) {
+		if (::toupper(a[i]) != ::toupper(b[i]))
+			return false;
+	}
+
+	return i == a.length() && b[i] == 0;
+}
+
+CAPRSReader::CAPRSReader(const std::string& apiKey, unsigned int refreshTime, const std::string& address, unsigned int port, const std::string& cacheFile, unsigned int cacheSize) :
 CThread(),
-m_ApiKey(ApiKey),
-m_cs(),
+m_ApiKey(apiKey),
 m_stop(false),
-m_new_callsign(false),
-m_refres_time(refres_time),
-m_lat_table(),
-m_lon_table(),
-m_time_table()
+m_refres_time(refreshTime),
+m_address(address),
+m_port(port),
+m_mutex(),
+m_changed(false),
+m_newApiKey(),
+m_newAddress(),
+m_newPort(0U),
+m_requests(APRS_QUEUE, "APRS Request"),
+m_results(APRS_QUEUE, "APRS Result"),
+m_cache(),
+m_index(),
+m_queued(),
+m_cacheFile(cacheFile),
+m_cacheSize(cacheSize > 0U ? cacheSize : 1U),
+m_socket(NULL),
+m_idle()
 {
-	m_lat_table.clear();
-	m_lon_table.clear();
-	m_time_table.clear();
+	loadCache();
+
+	setName("aprs-reader");
 	run();
 }
 
 CAPRSReader::~CAPRSReader()
 {
-
+	delete m_socket;
 }
 
 void CAPRSReader::entry()
@@ -79,21 +202,59 @@ void CAPRSReader::entry()
 	LogMessage("Started the APRS Reader lookup thread");
 
 	while (!m_stop) {
-		
-		while(!m_new_callsign)
-			sleep(1000U);
-		
-		load_call();
-		
-		m_new_callsign = false;
+		if (m_changed.exchange(false)) {
+			disconnect();
+
+			m_mutex.lock();
+			m_ApiKey  = m_newApiKey;
+			m_address = m_newAddress;
+			m_port    = m_newPort;
+			m_mutex.unlock();
+		}
+
+		if (m_requests.isEmpty()) {
+			if (m_socket != NULL && m_idle.elapsed() > APRS_IDLE_TIME)
+				disconnect();
+
+			sleep(100U);
+			continue;
+		}
+
+		CAPRSPosition positions[APRS_BATCH];
+		unsigned int count = 0U;
+		while (count < APRS_BATCH && m_requests.hasData())
+			m_requests.getData(positions + count++, 1U);
+
+		lookup(positions, count);
+
+		m_results.addData(positions, count);
 	}
 
+	disconnect();
+
 	LogMessage("Stopped the APRS Reader lookup thread");
 }
 
 void CAPRSReader::stop()
 {
 	m_stop = true;
+
+	wait();
+
+	saveCache();
+}
+
+void CAPRSReader::setServer(const std::string& apiKey, unsigned int refreshTime, const std::string& address, unsigned int port)
+{
+	m_refres_time = refreshTime;
+
+	m_mutex.lock();
+	m_newApiKey  = apiKey;
+	m_newAddress = address;
+	m_newPort    = port;
+	m_mutex.unlock();
+
+	m_changed = true;
 }
 
 void CAPRSReader::formatGPS(unsigned char *buffer, int latitude, int longitude)
@@ -173,127 +334,368 @@ void CAPRSReader::formatGPS(unsigned char *buffer, int latitude, int longitude)
 	*(buffer + 19U) = crc;
 }
 
-bool CAPRSReader::load_call() 
+// Runs on the reader thread, the cache belongs to the findCall() side
+void CAPRSReader::lookup(CAPRSPosition* positions, unsigned int count)
 {
+	assert(positions != NULL);
+	assert(count > 0U);
+
 	struct timeval timeinfo;
-	unsigned long epoch;
-
-	int longitude = 0;
-	int latitude = 0;
-	
-	unsigned char buffer[10000];
-	int nDataLength;
-	std::string website_HTML;
-
-	// get information
-	// LogMessage("Searching %s", callsign.c_str());
-	// website url
-	std::string url = "/api/get?name=" + m_cs + "-Y," + m_cs + "-7," + m_cs + "-8," + m_cs + "-9,";
-	url = url + m_cs + "-14," + m_cs + "&what=loc&apikey=" + m_ApiKey + "&format=json";
-	//HTTP GET
-	std::string get_http = "GET " + url + " HTTP/1.1\r\nHost: api.aprs.fi\r\nUser-Agent: YSF2DMR/0.12\r\n\r\n";		
-	CTCPSocket sockfd("api.aprs.fi", 80);
-
-	bool ret = sockfd.open();
-	if (!ret){
-		LogMessage("Could not connect to api.aprs.fi");
+	gettimeofday(&timeinfo, 0);
+
+	std::string names;
+	for (unsigned int i = 0U; i < count; i++) {
+		positions[i].m_latitude  = 0;
+		positions[i].m_longitude = 0;
+		positions[i].m_time      = timeinfo.tv_sec;
+
+		for (unsigned int j = 0U; j < APRS_SUFFIX_COUNT; j++) {
+			if (!names.empty())
+				names += ",";
+			names += std::string(positions[i].m_callsign) + APRS_SUFFIXES[j];
+		}
+	}
+
+	std::string url = "/api/get?name=" + names + "&what=loc&apikey=" + m_ApiKey + "&format=json";
+
+	// The server may have closed a kept connection meanwhile, so a failure
+	// on one is tried again once on a new connection
+	bool reused = m_socket != NULL;
+
+	bool ret = connect() && query(url, positions, count);
+	if (!ret && reused) {
+		disconnect();
+		ret = connect() && query(url, positions, count);
+	}
+
+	if (!ret) {
+		LogMessage("Could not look up the GPS positions on %s", m_address.c_str());
+		disconnect();
+		return;
+	}
+
+	m_idle.start();
+
+	for (unsigned int i = 0U; i < count; i++) {
+		if (positions[i].m_latitude == 0 || positions[i].m_longitude == 0)
+			LogMessage("GPS Position of %s not found", positions[i].m_callsign);
+		else
+			LogMessage("GPS Position of %s Lat: %0.3f, Lon: %0.3f", positions[i].m_callsign, (float)positions[i].m_latitude / 1000.0, (float)positions[i].m_longitude / 1000.0);
+	}
+}
+
+bool CAPRSReader::query(const std::string& url, CAPRSPosition* positions, unsigned int count)
+{
+	std::string get_http = "GET " + url + " HTTP/1.1\r\nHost: " + m_address + "\r\nUser-Agent: YSF2DMR/0.12\r\nConnection: keep-alive\r\n\r\n";
+
+	if (!m_socket->write((const unsigned char*)get_http.c_str(), (unsigned int)get_http.length()))
+		return false;
+
+	std::string line;
+	if (!readLine(line))
 		return false;
+
+	std::string::size_type pos = line.find(' ');
+	if (line.compare(0U, 5U, "HTTP/") != 0 || pos == std::string::npos)
+		return false;
+
+	unsigned int status = (unsigned int)::atoi(line.c_str() + pos + 1U);
+
+	bool hasLength = false;
+	bool chunked   = false;
+	bool close     = false;
+	unsigned int length = 0U;
+
+	for (;;) {
+		if (!readLine(line))
+			return false;
+
+		if (line.empty())
+			break;
+
+		pos = line.find(':');
+		if (pos == std::string::npos)
+			continue;
+
+		std::string name = line.substr(0U, pos);
+		for (std::string::iterator it = name.begin(); it != name.end(); ++it)
+			*it = ::tolower(*it);
+
+		std::string value = line.substr(pos + 1U);
+		for (std::string::iterator it = value.begin(); it != value.end(); ++it)
+			*it = ::tolower(*it);
+
+		if (name == "content-length") {
+			length    = (unsigned int)::strtoul(value.c_str(), NULL, 10);
+			hasLength = true;
+		} else if (name == "transfer-encoding") {
+			chunked = value.find("chunked") != std::string::npos;
+		} else if (name == "connection") {
+			close = value.find("close") != std::string::npos;
+		}
 	}
 
-	// send GET / HTTP
-	sockfd.write((const unsigned char*)get_http.c_str(), strlen(get_http.c_str()));
-
-	// recieve html
-	while ((nDataLength = sockfd.read(buffer, 10000, APRS_TIMEOUT)) > 0){
-		int i = 0;
-		char tmp_str[20];
-		for (i = 0; i < nDataLength; i++) {
-			if (i > 5 && buffer[i - 4] == '\"' && buffer[i - 3] == 'l' && buffer[i - 2] == 'a' && buffer[i - 1] == 't' && buffer[i] == '\"'){
-				::memcpy(tmp_str, buffer + i + 3, 8U);
-				tmp_str[8] = 0;
-				//LogMessage("Latitude: %s", tmp_str);
-				latitude = (int)(atof(tmp_str) * 1000);
-				m_lat_table[m_cs] = latitude;
-			}
-			if (i > 5 && buffer[i - 4] == '\"' && buffer[i - 3] == 'l' && buffer[i - 2] == 'n' && buffer[i - 1] == 'g' && buffer[i] == '\"'){
-				::memcpy(tmp_str,buffer + i + 3, 8U);
-				tmp_str[8] = 0;
-				//LogMessage("Longitude: %s", tmp_str);
-				longitude = (int)(atof(tmp_str) * 1000);
-				m_lon_table[m_cs] = longitude;
-			}
-			
-			if ((latitude != 0) && (longitude != 0))
+	CAPRSResponse response;
+
+	if (chunked) {
+		for (;;) {
+			if (!readLine(line))
+				return false;
+
+			unsigned int size = (unsigned int)::strtoul(line.c_str(), NULL, 16);
+			if (size == 0U)
 				break;
+
+			if (!readBody(response, size) || !readLine(line))
+				return false;
 		}
-		if ((latitude != 0) && (longitude != 0))
-			break;
+
+		// The trailer, if any
+		do {
+			if (!readLine(line))
+				return false;
+		} while (!line.empty());
+	} else if (hasLength) {
+		if (!readBody(response, length))
+			return false;
+	} else {
+		// Only the end of the connection ends the body
+		readBody(response, 0xFFFFFFFFU);
+		close = true;
 	}
 
-	sockfd.close();
+	if (close)
+		disconnect();
 
-	gettimeofday(&timeinfo, 0);
-	epoch = timeinfo.tv_sec;
-	m_time_table[m_cs] = epoch;
+	if (status != 200U || !response.isComplete()) {
+		LogMessage("Invalid reply from %s, status %u", m_address.c_str(), status);
+		return false;
+	}
 
-	if (latitude == 0 || longitude == 0) {
-		m_lat_table[m_cs] = 0;
-		m_lon_table[m_cs] = 0;
-		LogMessage("GPS Position of %s not found", m_cs.c_str());
+	if (response.m_result != "ok") {
+		LogMessage("Lookup refused by %s: %s", m_address.c_str(), response.m_description.c_str());
 		return false;
 	}
-	else {
-		LogMessage("GPS Position of %s Lat: %0.3f, Lon: %0.3f", m_cs.c_str(), (float)latitude / 1000.0, (float)longitude / 1000.0);
-		return true;
+
+	// Of all the SSIDs of a callsign, the one heard most recently wins
+	unsigned long latest[APRS_BATCH];
+	::memset(latest, 0x00U, sizeof(latest));
+
+	for (std::vector<CAPRSEntry>::const_iterator it = response.m_entries.begin(); it != response.m_entries.end(); ++it) {
+		std::string base = it->m_name.substr(0U, it->m_name.find('-'));
+
+		for (unsigned int i = 0U; i < count; i++) {
+			if (!sameCallsign(base, positions[i].m_callsign))
+				continue;
+
+			int latitude  = (int)(::atof(it->m_latitude.c_str()) * 1000);
+			int longitude = (int)(::atof(it->m_longitude.c_str()) * 1000);
+
+			if (latitude != 0 && longitude != 0 && (latest[i] == 0UL || it->m_time > latest[i])) {
+				positions[i].m_latitude  = latitude;
+				positions[i].m_longitude = longitude;
+				latest[i] = it->m_time > 0UL ? it->m_time : 1UL;
+			}
+		}
 	}
+
+	return true;
 }
 
-bool CAPRSReader::findCall(std::string cs, int *latitude, int *longitude)
+bool CAPRSReader::connect()
 {
-	bool not_found = false;
-	struct timeval timeinfo;
-	unsigned int epoch, tempo;
+	if (m_socket != NULL)
+		return true;
 
-	try {
-		*latitude = m_lat_table.at(cs);
-	} catch (...) {
-		not_found = true;
-	}
+	m_socket = new CTCPSocket(m_address, m_port);
 
-	try {
-		*longitude = m_lon_table.at(cs);
-	} catch (...) {
-		not_found = true;
+	bool ret = m_socket->open();
+	if (!ret) {
+		LogMessage("Could not connect to %s", m_address.c_str());
+		delete m_socket;
+		m_socket = NULL;
+		return false;
 	}
 
-	if (m_new_callsign) {
-		if (not_found)
-			return false;
-		else if ((*latitude != 0) && (*longitude != 0))
-			return true;
-		else
+	return true;
+}
+
+void CAPRSReader::disconnect()
+{
+	if (m_socket == NULL)
+		return;
+
+	m_socket->close();
+	delete m_socket;
+	m_socket = NULL;
+}
+
+bool CAPRSReader::readLine(std::string& line)
+{
+	if (m_socket->readLine(line, APRS_TIMEOUT) <= 0)
+		return false;
+
+	line.erase(line.find_last_not_of("\r\n") + 1U);
+
+	return true;
+}
+
+bool CAPRSReader::readBody(CJSONParser& parser, unsigned int length)
+{
+	unsigned char buffer[1024U];
+
+	while (length > 0U) {
+		int len = m_socket->read(buffer, length < sizeof(buffer) ? length : sizeof(buffer), APRS_TIMEOUT);
+		if (len <= 0)
 			return false;
-	} 
 
-	if (not_found) {
-		m_new_callsign = true;
-		m_cs = cs;
+		parser.feed(buffer, (unsigned int)len);
+
+		length -= (unsigned int)len;
+	}
+
+	return true;
+}
+
+bool CAPRSReader::findCall(const std::string& cs, int *latitude, int *longitude)
+{
+	// Pick up the lookups completed by the reader thread
+	while (m_results.hasData()) {
+		CAPRSPosition position;
+		m_results.getData(&position, 1U);
+
+		m_queued.erase(position.m_callsign);
+		store(position);
+	}
+
+	std::unordered_map<std::string, std::list<CAPRSPosition>::iterator>::iterator it = m_index.find(cs);
+	if (it == m_index.end()) {
+		request(cs);
 		return false;
 	}
-	else {
-		gettimeofday(&timeinfo, 0);
-		epoch = timeinfo.tv_sec;
-		tempo = m_time_table.at(cs);
-
-		if (epoch > (tempo + m_refres_time)) {
-			//LogMessage("Location expired");
-			m_new_callsign = true;
-			m_cs = cs;
+
+	m_cache.splice(m_cache.begin(), m_cache, it->second);
+
+	const CAPRSPosition& position = *it->second;
+
+	struct timeval timeinfo;
+	gettimeofday(&timeinfo, 0);
+
+	if ((unsigned int)timeinfo.tv_sec > position.m_time + m_refres_time) {
+		//LogMessage("Location expired");
+		request(cs);
+	}
+
+	if (position.m_latitude == 0 || position.m_longitude == 0)
+		return false;
+
+	*latitude  = position.m_latitude;
+	*longitude = position.m_longitude;
+
+	return true;
+}
+
+// Each callsign is looked up once at a time, however often it is asked for
+void CAPRSReader::request(const std::string& cs)
+{
+	if (m_queued.count(cs) > 0U || m_queued.size() >= APRS_QUEUE)
+		return;
+
+	CAPRSPosition position;
+	::memset(&position, 0x00U, sizeof(CAPRSPosition));
+	::strncpy(position.m_callsign, cs.c_str(), sizeof(position.m_callsign) - 1U);
+
+	if (m_requests.addData(&position, 1U))
+		m_queued.insert(cs);
+}
+
+// A lookup that finds nothing keeps the position already known, if any
+void CAPRSReader::store(const CAPRSPosition& position)
+{
+	std::string cs = position.m_callsign;
+
+	std::unordered_map<std::string, std::list<CAPRSPosition>::iterator>::iterator it = m_index.find(cs);
+	if (it != m_index.end()) {
+		CAPRSPosition& entry = *it->second;
+
+		if (position.m_latitude != 0 && position.m_longitude != 0) {
+			entry.m_latitude  = position.m_latitude;
+			entry.m_longitude = position.m_longitude;
 		}
+		entry.m_time = position.m_time;
 
-		if ((*latitude != 0) && (*longitude != 0))
-			return true;
-		else
-			return false;
+		m_cache.splice(m_cache.begin(), m_cache, it->second);
+		return;
+	}
+
+	m_cache.push_front(position);
+	m_index[cs] = m_cache.begin();
+
+	if (m_cache.size() > m_cacheSize) {
+		m_index.erase(m_cache.back().m_callsign);
+		m_cache.pop_back();
+	}
+}
+
+// The file holds one position per line, the most recently used first
+void CAPRSReader::loadCache()
+{
+	if (m_cacheFile.empty())
+		return;
+
+	FILE* fp = ::fopen(m_cacheFile.c_str(), "rt");
+	if (fp == NULL)
+		return;
+
+	char buffer[100U];
+	while (::fgets(buffer, sizeof(buffer), fp) != NULL && m_cache.size() < m_cacheSize) {
+		CAPRSPosition position;
+		::memset(&position, 0x00U, sizeof(CAPRSPosition));
+
+		if (::sscanf(buffer, "%15s %d %d %u", position.m_callsign, &position.m_latitude, &position.m_longitude, &position.m_time) != 4)
+			continue;
+
+		if (m_index.count(position.m_callsign) > 0U)
+			continue;
+
+		m_cache.push_back(position);
+		m_index[position.m_callsign] = --m_cache.end();
+	}
+
+	::fclose(fp);
+
+	LogMessage("Loaded %u GPS positions from %s", (unsigned int)m_cache.size(), m_cacheFile.c_str());
+}
+
+// Written beside the old file and moved over it, so a crash cannot leave half a cache
+void CAPRSReader::saveCache() const
+{
+	if (m_cacheFile.empty())
+		return;
+
+	std::string temp = m_cacheFile + ".tmp";
+
+	FILE* fp = ::fopen(temp.c_str(), "wt");
+	if (fp == NULL) {
+		LogWarning("Cannot write the GPS positions to %s", temp.c_str());
+		return;
 	}
+
+	unsigned int count = 0U;
+	for (std::list<CAPRSPosition>::const_iterator it = m_cache.begin(); it != m_cache.end(); ++it) {
+		if (it->m_latitude == 0 || it->m_longitude == 0)
+			continue;
+
+		::fprintf(fp, "%s %d %d %u\n", it->m_callsign, it->m_latitude, it->m_longitude, it->m_time);
+		count++;
+	}
+
+	::fclose(fp);
+
+	if (::rename(temp.c_str(), m_cacheFile.c_str()) != 0) {
+		::remove(m_cacheFile.c_str());
+		::rename(temp.c_str(), m_cacheFile.c_str());
+	}
+
+	LogMessage("Saved %u GPS positions to %s", count, m_cacheFile.c_str());
 }
@@ -20,34 +20,83 @@
 #ifndef	APRSReader_H
 #define	APRSReader_H
 
+#include "SPSCRingBuffer.h"
 #include "TCPSocket.h"
+#include "StopWatch.h"
+#include "JSONParser.h"
 #include "Thread.h"
 #include "Mutex.h"
 
 #include <string>
+#include <atomic>
+#include <list>
 #include <unordered_map>
+#include <unordered_set>
 
+// A position lookup, passed to the reader thread with only the callsign set
+// and passed back with the result, a position of zero when none was found
+class CAPRSPosition {
+public:
+	char         m_callsign[16U];
+	int          m_latitude;
+	int          m_longitude;
+	unsigned int m_time;
+};
+
+// Positions are looked up on aprs.fi by a thread of their own, several
+// callsigns to a request over a connection that is kept open. The results
+// are held in a cache of bounded size, saved to a file between runs.
 class CAPRSReader : public CThread  {
 public:
-	CAPRSReader(std::string ApiKey, int refres_time);
+	CAPRSReader(const std::string& apiKey, unsigned int refreshTime, const std::string& address, unsigned int port, const std::string& cacheFile, unsigned int cacheSize);
 	virtual ~CAPRSReader();
 
 	virtual void entry();
 	
-	bool findCall(std::string cs, int *latitude, int *longitude);
+	bool findCall(const std::string& cs, int *latitude, int *longitude);
     void formatGPS(unsigned char *buffer, int latitude, int longitude);
 	void stop();
-	bool load_call();
+
+	// Taken up by the reader thread before its next lookup
+	void setServer(const std::string& apiKey, unsigned int refreshTime, const std::string& address, unsigned int port);
 
 private:
 	std::string m_ApiKey;
-	std::string m_cs;
-	bool m_stop;
-	bool m_new_callsign;
-	unsigned int  m_refres_time;
-	std::unordered_map<std::string, int> m_lat_table;
-	std::unordered_map<std::string, int> m_lon_table;
-	std::unordered_map<std::string, unsigned int> m_time_table;
+	std::atomic<bool> m_stop;
+	std::atomic<unsigned int> m_refres_time;
+	std::string   m_address;
+	unsigned int  m_port;
+
+	// Set by setServer() for the reader thread
+	CMutex        m_mutex;
+	std::atomic<bool> m_changed;
+	std::string   m_newApiKey;
+	std::string   m_newAddress;
+	unsigned int  m_newPort;
+	CSPSCRingBuffer<CAPRSPosition> m_requests;
+	CSPSCRingBuffer<CAPRSPosition> m_results;
+
+	// Owned by the findCall() side, the most recently used first
+	std::list<CAPRSPosition> m_cache;
+	std::unordered_map<std::string, std::list<CAPRSPosition>::iterator> m_index;
+	std::unordered_set<std::string> m_queued;
+	std::string   m_cacheFile;
+	unsigned int  m_cacheSize;
+
+	// Owned by the reader thread
+	CTCPSocket*   m_socket;
+	CStopWatch    m_idle;
+
+	void lookup(CAPRSPosition* positions, unsigned int count);
+	bool query(const std::string& url, CAPRSPosition* positions, unsigned int count);
+	bool connect();
+	void disconnect();
+	bool readLine(std::string& line);
+	bool readBody(CJSONParser& parser, unsigned int length);
+	void request(const std::string& cs);
+	void store(const CAPRSPosition& position);
+	void loadCache();
+	void saveCache() const;
 };
 
 #endif
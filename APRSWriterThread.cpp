@@ -34,6 +34,12 @@ const unsigned int CALLSIGN_LENGTH = 8U;
 
 const unsigned int APRS_TIMEOUT = 10U;
 
+// How long a read waits before the queue is looked at again, in ms
+const unsigned int APRS_POLL_TIME = 100U;
+
+// Frames written while this much is still waiting to go out are dropped
+const unsigned int APRS_OUTPUT_LENGTH = 8192U;
+
 CAPRSWriterThread::CAPRSWriterThread(const std::string& callsign, const std::string& password, const std::string& address, unsigned int port) :
 CThread(),
 m_username(callsign),
@@ -44,7 +50,8 @@ m_exit(false),
 m_connected(false),
 m_APRSReadCallback(NULL),
 m_filter(),
-m_clientName("YSF2DMR")
+m_clientName("YSF2DMR"),
+m_output()
 {
 	assert(!callsign.empty());
 	assert(!password.empty());
@@ -66,7 +73,8 @@ m_exit(false),
 m_connected(false),
 m_APRSReadCallback(NULL),
 m_filter(filter),
-m_clientName(clientName)
+m_clientName(clientName),
+m_output()
 {
 	assert(!callsign.empty());
 	assert(!password.empty());
@@ -85,6 +93,7 @@ CAPRSWriterThread::~CAPRSWriterThread()
 
 bool CAPRSWriterThread::start()
 {
+	setName("aprs-writer");
 	run();
 
 	return true;
@@ -108,30 +117,44 @@ void CAPRSWriterThread::entry()
 			}
 
 			if (m_connected) {
-				if (!m_queue.isEmpty()){
+				// All the queued frames are taken at once, and whatever the
+				// socket does not accept now is sent on a later pass
+				while (!m_queue.isEmpty()) {
 					char* p = NULL;
 					m_queue.getData(&p, 1U);
 
 					LogMessage("APRS ==> %s", p);
 
-					::strcat(p, "\r\n");
+					if (m_output.length() + ::strlen(p) + 2U > APRS_OUTPUT_LENGTH) {
+						LogWarning("The APRS server is not keeping up, dropping a frame");
+					} else {
+						m_output += p;
+						m_output += "\r\n";
+					}
 
-					bool ret = m_socket.write((unsigned char*)p, ::strlen(p));
-					if (!ret) {
+					delete[] p;
+				}
+
+				if (!m_output.empty()) {
+					int ret = m_socket.writeNoWait((const unsigned char*)m_output.c_str(), (unsigned int)m_output.length());
+					if (ret < 0) {
 						m_connected = false;
 						m_socket.close();
+						m_output.clear();
 						LogError("Connection to the APRS thread has failed");
+					} else {
+						m_output.erase(0U, (std::string::size_type)ret);
 					}
-
-					delete[] p;
 				}
-				{
+
+				if (m_connected) {
 					std::string line;
-					int length = m_socket.readLine(line, APRS_TIMEOUT);
+					int length = m_socket.readLine(line, 0U, APRS_POLL_TIME);
 
 					if (length < 0) {
 						m_connected = false;
 						m_socket.close();
+						m_output.clear();
 						LogError("Error when reading from the APRS server");
 					}
 
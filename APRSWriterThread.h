@@ -20,10 +20,11 @@
 #define	APRSWriterThread_H
 
 #include "TCPSocket.h"
-#include "RingBuffer.h"
+#include "MPSCRingBuffer.h"
 #include "Thread.h"
 
 #include <string>
+#include <atomic>
 
 typedef void (*ReadAPRSFrameCallback)(const std::string&);
 
@@ -49,12 +50,13 @@ private:
 	std::string            m_username;
 	std::string            m_password;
 	CTCPSocket             m_socket;
-	CRingBuffer<char*>     m_queue;
-	bool                   m_exit;
-	bool                   m_connected;
+	CMPSCRingBuffer<char*> m_queue;
+	std::atomic<bool>      m_exit;
+	std::atomic<bool>      m_connected;
 	ReadAPRSFrameCallback  m_APRSReadCallback;
 	std::string            m_filter;
 	std::string            m_clientName;
+	std::string            m_output;
 
 	bool connect();
 };
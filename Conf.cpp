@@ -35,7 +35,11 @@ enum SECTION {
   SECTION_DMR_NETWORK,
   SECTION_DMRID_LOOKUP,
   SECTION_LOG,
-  SECTION_APRS_FI
+  SECTION_APRS_FI,
+  SECTION_TRANSCODER,
+  SECTION_LAST_HEARD,
+  SECTION_SLOT1,
+  SECTION_DMR_FANOUT
 };
 
 CConf::CConf(const std::string& file) :
@@ -48,6 +52,9 @@ m_localAddress(),
 m_localPort(0U),
 m_enableWiresX(false),
 m_daemon(false),
+m_reflectorMode(false),
+m_clientTimeout(60U),
+m_maxClients(50U),
 m_rxFrequency(0U),
 m_txFrequency(0U),
 m_power(0U),
@@ -74,6 +81,14 @@ m_dmrNetworkJitter(500U),
 m_dmrNetworkEnableUnlink(true),
 m_dmrNetworkIDUnlink(4000U),
 m_dmrNetworkPCUnlink(false),
+m_dmrNetworkUnlinkTimeout(1500U),
+m_dmrNetworkReplyDelay(100U),
+m_dmrNetworkPTTDelay(150U),
+m_dmrNetworkArbitration(0U),
+m_dmrNetworkPriorityTG(0U),
+m_dmrNetworkHangTime(3U),
+m_dmrNetworkFailovers(),
+m_dmrNetworkStandby(false),
 m_dmrIdLookupFile(),
 m_dmrIdLookupTime(0U),
 m_logDisplayLevel(0U),
@@ -86,7 +101,26 @@ m_aprsPort(0U),
 m_aprsPassword(),
 m_aprsAPIKey(),
 m_aprsRefresh(120),
-m_aprsDescription()
+m_aprsDescription(),
+m_aprsAPIServer("api.aprs.fi"),
+m_aprsAPIPort(80U),
+m_aprsCacheFile(),
+m_aprsCacheSize(1000U),
+m_transcoderLatency(200U),
+m_transcoderPriority(0U),
+m_transcoderRoundRobin(false),
+m_transcoderCPUs(),
+m_transcoderLockMemory(false),
+m_lastHeardEnabled(false),
+m_lastHeardName("/YSF2DMR"),
+m_slot1Enabled(false),
+m_slot1DstAddress(),
+m_slot1DstPort(0U),
+m_slot1LocalAddress(),
+m_slot1LocalPort(0U),
+m_slot1DstId(0U),
+m_slot1PC(false),
+m_dmrFanOuts()
 {
 }
 
@@ -122,7 +156,17 @@ bool CConf::read()
 		  section = SECTION_LOG;
 	  else if (::strncmp(buffer, "[aprs.fi]", 5U) == 0)
 		  section = SECTION_APRS_FI;	  
-	  else
+	  else if (::strncmp(buffer, "[Transcoder]", 12U) == 0)
+		  section = SECTION_TRANSCODER;
+	  else if (::strncmp(buffer, "[Last Heard]", 12U) == 0)
+		  section = SECTION_LAST_HEARD;
+	  else if (::strncmp(buffer, "[Slot 1]", 8U) == 0)
+		  section = SECTION_SLOT1;
+	  else if (::strncmp(buffer, "[DMR Fan Out", 12U) == 0) {
+		  // Every such section adds another master
+		  m_dmrFanOuts.push_back(CDMRFanOutConf());
+		  section = SECTION_DMR_FANOUT;
+	  } else
         section = SECTION_NONE;
 
       continue;
@@ -166,6 +210,12 @@ bool CConf::read()
 			m_enableWiresX = ::atoi(value) == 1;
 		else if (::strcmp(key, "Daemon") == 0)
 			m_daemon = ::atoi(value) == 1;
+		else if (::strcmp(key, "ReflectorMode") == 0)
+			m_reflectorMode = ::atoi(value) == 1;
+		else if (::strcmp(key, "ClientTimeout") == 0)
+			m_clientTimeout = (unsigned int)::atoi(value);
+		else if (::strcmp(key, "MaxClients") == 0)
+			m_maxClients = (unsigned int)::atoi(value);
 	} else if (section == SECTION_INFO) {
 		if (::strcmp(key, "TXFrequency") == 0)
 			m_txFrequency = (unsigned int)::atoi(value);
@@ -223,6 +273,22 @@ bool CConf::read()
 			m_dmrNetworkIDUnlink = (unsigned int)::atoi(value);
 		else if (::strcmp(key, "PCUnlink") == 0)
 			m_dmrNetworkPCUnlink = ::atoi(value) == 1;
+		else if (::strcmp(key, "UnlinkTimeout") == 0)
+			m_dmrNetworkUnlinkTimeout = (unsigned int)::atoi(value);
+		else if (::strcmp(key, "ReplyDelay") == 0)
+			m_dmrNetworkReplyDelay = (unsigned int)::atoi(value);
+		else if (::strcmp(key, "PTTDelay") == 0)
+			m_dmrNetworkPTTDelay = (unsigned int)::atoi(value);
+		else if (::strcmp(key, "Arbitration") == 0)
+			m_dmrNetworkArbitration = (unsigned int)::atoi(value);
+		else if (::strcmp(key, "PriorityTG") == 0)
+			m_dmrNetworkPriorityTG = (unsigned int)::atoi(value);
+		else if (::strcmp(key, "HangTime") == 0)
+			m_dmrNetworkHangTime = (unsigned int)::atoi(value);
+		else if (::strcmp(key, "Failover") == 0)
+			m_dmrNetworkFailovers.push_back(value);
+		else if (::strcmp(key, "Standby") == 0)
+			m_dmrNetworkStandby = ::atoi(value) == 1;
 		else if (::strcmp(key, "TGListFile") == 0)
 			m_dmrTGListFile = value;
 	} else if (section == SECTION_DMRID_LOOKUP) {
@@ -254,6 +320,69 @@ bool CConf::read()
 			m_aprsRefresh = (unsigned int)::atoi(value);		
 		else if (::strcmp(key, "Description") == 0)
 			m_aprsDescription = value;	
+		else if (::strcmp(key, "APIServer") == 0)
+			m_aprsAPIServer = value;
+		else if (::strcmp(key, "APIPort") == 0)
+			m_aprsAPIPort = (unsigned int)::atoi(value);
+		else if (::strcmp(key, "CacheFile") == 0)
+			m_aprsCacheFile = value;
+		else if (::strcmp(key, "CacheSize") == 0)
+			m_aprsCacheSize = (unsigned int)::atoi(value);
+	} else if (section == SECTION_TRANSCODER) {
+		if (::strcmp(key, "Latency") == 0)
+			m_transcoderLatency = (unsigned int)::atoi(value);
+		else if (::strcmp(key, "Priority") == 0)
+			m_transcoderPriority = (unsigned int)::atoi(value);
+		else if (::strcmp(key, "Policy") == 0)
+			m_transcoderRoundRobin = ::strcmp(value, "RR") == 0 || ::strcmp(value, "rr") == 0;
+		else if (::strcmp(key, "CPUs") == 0) {
+			char* p = ::strtok(value, ",\r\n \t");
+			while (p != NULL) {
+				m_transcoderCPUs.push_back((unsigned int)::atoi(p));
+				p = ::strtok(NULL, ",\r\n \t");
+			}
+		} else if (::strcmp(key, "LockMemory") == 0)
+			m_transcoderLockMemory = ::atoi(value) == 1;
+	} else if (section == SECTION_LAST_HEARD) {
+		if (::strcmp(key, "Enable") == 0)
+			m_lastHeardEnabled = ::atoi(value) == 1;
+		else if (::strcmp(key, "Name") == 0)
+			m_lastHeardName = value;
+	} else if (section == SECTION_SLOT1) {
+		if (::strcmp(key, "Enable") == 0)
+			m_slot1Enabled = ::atoi(value) == 1;
+		else if (::strcmp(key, "DstAddress") == 0)
+			m_slot1DstAddress = value;
+		else if (::strcmp(key, "DstPort") == 0)
+			m_slot1DstPort = (unsigned int)::atoi(value);
+		else if (::strcmp(key, "LocalAddress") == 0)
+			m_slot1LocalAddress = value;
+		else if (::strcmp(key, "LocalPort") == 0)
+			m_slot1LocalPort = (unsigned int)::atoi(value);
+		else if (::strcmp(key, "DstId") == 0)
+			m_slot1DstId = (unsigned int)::atoi(value);
+		else if (::strcmp(key, "PC") == 0)
+			m_slot1PC = ::atoi(value) == 1;
+	} else if (section == SECTION_DMR_FANOUT) {
+		CDMRFanOutConf& fanOut = m_dmrFanOuts.back();
+		if (::strcmp(key, "Address") == 0)
+			fanOut.m_address = value;
+		else if (::strcmp(key, "Port") == 0)
+			fanOut.m_port = (unsigned int)::atoi(value);
+		else if (::strcmp(key, "Local") == 0)
+			fanOut.m_local = (unsigned int)::atoi(value);
+		else if (::strcmp(key, "Password") == 0)
+			fanOut.m_password = value;
+		else if (::strcmp(key, "Options") == 0)
+			fanOut.m_options = value;
+		else if (::strcmp(key, "Id") == 0)
+			fanOut.m_id = (unsigned int)::atoi(value);
+		else if (::strcmp(key, "DstId") == 0)
+			fanOut.m_dstId = (unsigned int)::atoi(value);
+		else if (::strcmp(key, "PC") == 0)
+			fanOut.m_pc = ::atoi(value) == 1;
+		else if (::strcmp(key, "Debug") == 0)
+			fanOut.m_debug = ::atoi(value) == 1;
 	}
   }
 
@@ -302,6 +431,21 @@ bool CConf::getDaemon() const
 	return m_daemon;
 }
 
+bool CConf::getReflectorMode() const
+{
+	return m_reflectorMode;
+}
+
+unsigned int CConf::getClientTimeout() const
+{
+	return m_clientTimeout;
+}
+
+unsigned int CConf::getMaxClients() const
+{
+	return m_maxClients;
+}
+
 unsigned int CConf::getRxFrequency() const
 {
 	return m_rxFrequency;
@@ -412,6 +556,26 @@ std::string CConf::getAPRSDescription() const
 	return m_aprsDescription;
 }
 
+std::string CConf::getAPRSAPIServer() const
+{
+	return m_aprsAPIServer;
+}
+
+unsigned int CConf::getAPRSAPIPort() const
+{
+	return m_aprsAPIPort;
+}
+
+std::string CConf::getAPRSCacheFile() const
+{
+	return m_aprsCacheFile;
+}
+
+unsigned int CConf::getAPRSCacheSize() const
+{
+	return m_aprsCacheSize;
+}
+
 std::string CConf::getDMRNetworkAddress() const
 {
 	return m_dmrNetworkAddress;
@@ -467,6 +631,46 @@ bool CConf::getDMRNetworkPCUnlink() const
 	return m_dmrNetworkPCUnlink;
 }
 
+unsigned int CConf::getDMRNetworkUnlinkTimeout() const
+{
+	return m_dmrNetworkUnlinkTimeout;
+}
+
+unsigned int CConf::getDMRNetworkReplyDelay() const
+{
+	return m_dmrNetworkReplyDelay;
+}
+
+unsigned int CConf::getDMRNetworkPTTDelay() const
+{
+	return m_dmrNetworkPTTDelay;
+}
+
+unsigned int CConf::getDMRNetworkArbitration() const
+{
+	return m_dmrNetworkArbitration;
+}
+
+unsigned int CConf::getDMRNetworkPriorityTG() const
+{
+	return m_dmrNetworkPriorityTG;
+}
+
+unsigned int CConf::getDMRNetworkHangTime() const
+{
+	return m_dmrNetworkHangTime;
+}
+
+std::vector<std::string> CConf::getDMRNetworkFailovers() const
+{
+	return m_dmrNetworkFailovers;
+}
+
+bool CConf::getDMRNetworkStandby() const
+{
+	return m_dmrNetworkStandby;
+}
+
 std::string CConf::getDMRTGListFile() const
 {
 	return m_dmrTGListFile;
@@ -501,3 +705,78 @@ std::string CConf::getLogFileRoot() const
 {
   return m_logFileRoot;
 }
+
+unsigned int CConf::getTranscoderLatency() const
+{
+	return m_transcoderLatency;
+}
+
+unsigned int CConf::getTranscoderPriority() const
+{
+	return m_transcoderPriority;
+}
+
+bool CConf::getTranscoderRoundRobin() const
+{
+	return m_transcoderRoundRobin;
+}
+
+std::vector<unsigned int> CConf::getTranscoderCPUs() const
+{
+	return m_transcoderCPUs;
+}
+
+bool CConf::getTranscoderLockMemory() const
+{
+	return m_transcoderLockMemory;
+}
+
+bool CConf::getLastHeardEnabled() const
+{
+	return m_lastHeardEnabled;
+}
+
+std::string CConf::getLastHeardName() const
+{
+	return m_lastHeardName;
+}
+
+bool CConf::getSlot1Enabled() const
+{
+	return m_slot1Enabled;
+}
+
+std::string CConf::getSlot1DstAddress() const
+{
+	return m_slot1DstAddress;
+}
+
+unsigned int CConf::getSlot1DstPort() const
+{
+	return m_slot1DstPort;
+}
+
+std::string CConf::getSlot1LocalAddress() const
+{
+	return m_slot1LocalAddress;
+}
+
+unsigned int CConf::getSlot1LocalPort() const
+{
+	return m_slot1LocalPort;
+}
+
+unsigned int CConf::getSlot1DstId() const
+{
+	return m_slot1DstId;
+}
+
+bool CConf::getSlot1PC() const
+{
+	return m_slot1PC;
+}
+
+std::vector<CDMRFanOutConf> CConf::getDMRFanOuts() const
+{
+	return m_dmrFanOuts;
+}
@@ -24,6 +24,34 @@
 #include <string>
 #include <vector>
 
+// One extra DMR master fed from the primary YSF->DMR transcoder
+class CDMRFanOutConf
+{
+public:
+  CDMRFanOutConf() :
+  m_address(),
+  m_port(0U),
+  m_local(0U),
+  m_password(),
+  m_options(),
+  m_id(0U),
+  m_dstId(9U),
+  m_pc(false),
+  m_debug(false)
+  {
+  }
+
+  std::string  m_address;
+  unsigned int m_port;
+  unsigned int m_local;
+  std::string  m_password;
+  std::string  m_options;
+  unsigned int m_id;
+  unsigned int m_dstId;
+  bool         m_pc;
+  bool         m_debug;
+};
+
 class CConf
 {
 public:
@@ -41,6 +69,9 @@ public:
   unsigned int getLocalPort() const;
   bool         getEnableWiresX() const;
   bool         getDaemon() const;
+  bool         getReflectorMode() const;
+  unsigned int getClientTimeout() const;
+  unsigned int getMaxClients() const;
 
   // The Info section
   unsigned int getRxFrequency() const;
@@ -71,6 +102,14 @@ public:
   bool         getDMRNetworkEnableUnlink() const;
   unsigned int getDMRNetworkIDUnlink() const;
   bool         getDMRNetworkPCUnlink() const;
+  unsigned int getDMRNetworkUnlinkTimeout() const;
+  unsigned int getDMRNetworkReplyDelay() const;
+  unsigned int getDMRNetworkPTTDelay() const;
+  unsigned int getDMRNetworkArbitration() const;
+  unsigned int getDMRNetworkPriorityTG() const;
+  unsigned int getDMRNetworkHangTime() const;
+  std::vector<std::string> getDMRNetworkFailovers() const;
+  bool         getDMRNetworkStandby() const;
   std::string  getDMRTGListFile() const;
 
   // The DMR Id section
@@ -91,6 +130,33 @@ public:
   std::string  getAPRSAPIKey() const;
   unsigned int getAPRSRefresh() const;  
   std::string  getAPRSDescription() const;  
+  std::string  getAPRSAPIServer() const;
+  unsigned int getAPRSAPIPort() const;
+  std::string  getAPRSCacheFile() const;
+  unsigned int getAPRSCacheSize() const;
+
+  // The Transcoder section
+  unsigned int getTranscoderLatency() const;
+  unsigned int getTranscoderPriority() const;
+  bool         getTranscoderRoundRobin() const;
+  std::vector<unsigned int> getTranscoderCPUs() const;
+  bool         getTranscoderLockMemory() const;
+
+  // The Last Heard section
+  bool         getLastHeardEnabled() const;
+  std::string  getLastHeardName() const;
+
+  // The Slot 1 section
+  bool         getSlot1Enabled() const;
+  std::string  getSlot1DstAddress() const;
+  unsigned int getSlot1DstPort() const;
+  std::string  getSlot1LocalAddress() const;
+  unsigned int getSlot1LocalPort() const;
+  unsigned int getSlot1DstId() const;
+  bool         getSlot1PC() const;
+
+  // The DMR Fan Out sections
+  std::vector<CDMRFanOutConf> getDMRFanOuts() const;
 
 private:
   std::string  m_file;
@@ -102,6 +168,9 @@ private:
   unsigned int m_localPort;
   bool         m_enableWiresX;
   bool         m_daemon;
+  bool         m_reflectorMode;
+  unsigned int m_clientTimeout;
+  unsigned int m_maxClients;
 
   unsigned int m_rxFrequency;
   unsigned int m_txFrequency;
@@ -130,6 +199,14 @@ private:
   bool         m_dmrNetworkEnableUnlink;
   unsigned int m_dmrNetworkIDUnlink;
   bool         m_dmrNetworkPCUnlink;
+  unsigned int m_dmrNetworkUnlinkTimeout;
+  unsigned int m_dmrNetworkReplyDelay;
+  unsigned int m_dmrNetworkPTTDelay;
+  unsigned int m_dmrNetworkArbitration;
+  unsigned int m_dmrNetworkPriorityTG;
+  unsigned int m_dmrNetworkHangTime;
+  std::vector<std::string> m_dmrNetworkFailovers;
+  bool         m_dmrNetworkStandby;
   std::string  m_dmrTGListFile;
 
   std::string  m_dmrIdLookupFile;
@@ -147,7 +224,29 @@ private:
   std::string  m_aprsAPIKey;
   unsigned int m_aprsRefresh;
   std::string  m_aprsDescription;
+  std::string  m_aprsAPIServer;
+  unsigned int m_aprsAPIPort;
+  std::string  m_aprsCacheFile;
+  unsigned int m_aprsCacheSize;
+
+  unsigned int m_transcoderLatency;
+  unsigned int m_transcoderPriority;
+  bool         m_transcoderRoundRobin;
+  std::vector<unsigned int> m_transcoderCPUs;
+  bool         m_transcoderLockMemory;
+
+  bool         m_lastHeardEnabled;
+  std::string  m_lastHeardName;
+
+  bool         m_slot1Enabled;
+  std::string  m_slot1DstAddress;
+  unsigned int m_slot1DstPort;
+  std::string  m_slot1LocalAddress;
+  unsigned int m_slot1LocalPort;
+  unsigned int m_slot1DstId;
+  bool         m_slot1PC;
 
+  std::vector<CDMRFanOutConf> m_dmrFanOuts;
 };
 
 #endif
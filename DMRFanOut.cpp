@@ -0,0 +1,148 @@
+/*
+*   Copyright (C) 2018 by Andy Uribe CA6JAU
+*
+*   This program is free software; you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation; either version 2 of the License, or
+*   (at your option) any later version.
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program; if not, write to the Free Software
+*   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+*/
+
+#include "DMRFanOut.h"
+#include "Sync.h"
+
+#include <cstdio>
+#include <cassert>
+#include <cstring>
+
+CDMRFanOutTarget::CDMRFanOutTarget(CDMRNetwork* network, unsigned int dstId, FLCO flco) :
+m_network(network),
+m_dstId(dstId),
+m_flco(flco),
+m_lc()
+{
+}
+
+CDMRFanOut::CDMRFanOut(unsigned int slotNo, unsigned char colorCode) :
+m_slotNo(slotNo),
+m_colorCode(colorCode),
+m_lcCache(16U),
+m_targets(),
+m_count(0U)
+{
+	assert(slotNo == 1U || slotNo == 2U);
+}
+
+CDMRFanOut::~CDMRFanOut()
+{
+}
+
+void CDMRFanOut::add(CDMRNetwork* network, unsigned int dstId, FLCO flco)
+{
+	assert(network != NULL);
+
+	m_targets.push_back(CDMRFanOutTarget(network, dstId, flco));
+}
+
+void CDMRFanOut::writeHeader(unsigned int srcId, unsigned int dstId, FLCO flco)
+{
+	unsigned char buffer[DMR_FRAME_LENGTH_BYTES];
+
+	for (std::vector<CDMRFanOutTarget>::iterator it = m_targets.begin(); it != m_targets.end(); ++it) {
+		refresh(*it, srcId, dstId, flco);
+
+		// Full LC, SlotType and sync from the LC cache
+		it->m_lc.getHeader(buffer, false);
+
+		for (unsigned int i = 0U; i < 3U; i++)
+			write(*it, srcId, dstId, flco, DT_VOICE_LC_HEADER, i, 0U, buffer);
+	}
+
+	m_count = 3U;
+}
+
+void CDMRFanOut::writeData(unsigned int srcId, unsigned int dstId, FLCO flco, const unsigned char* data)
+{
+	assert(data != NULL);
+
+	unsigned char buffer[DMR_FRAME_LENGTH_BYTES];
+	unsigned int n = (m_count - 3U) % 6U;
+
+	for (std::vector<CDMRFanOutTarget>::iterator it = m_targets.begin(); it != m_targets.end(); ++it) {
+		::memcpy(buffer, data, DMR_FRAME_LENGTH_BYTES);
+
+		if (n == 0U) {
+			CSync::addDMRAudioSync(buffer, 0U);
+			// Refresh the Embedded LC if the stream parameters have changed
+			refresh(*it, srcId, dstId, flco);
+			write(*it, srcId, dstId, flco, DT_VOICE_SYNC, m_count, n, buffer);
+		} else {
+			// Add the Embedded LC and EMB
+			it->m_lc.getEmbeddedData(buffer, n);
+			write(*it, srcId, dstId, flco, DT_VOICE, m_count, n, buffer);
+		}
+	}
+
+	m_count++;
+}
+
+void CDMRFanOut::writeTerminator(unsigned int srcId, unsigned int dstId, FLCO flco)
+{
+	// Complete the superframe with silence first
+	while ((m_count - 3U) % 6U != 0U)
+		writeData(srcId, dstId, flco, DMR_SILENCE_DATA);
+
+	unsigned char buffer[DMR_FRAME_LENGTH_BYTES];
+
+	for (std::vector<CDMRFanOutTarget>::iterator it = m_targets.begin(); it != m_targets.end(); ++it) {
+		refresh(*it, srcId, dstId, flco);
+
+		// Full LC, SlotType and sync from the LC cache
+		it->m_lc.getTerminator(buffer, false);
+
+		write(*it, srcId, dstId, flco, DT_TERMINATOR_WITH_LC, m_count, 0U, buffer);
+	}
+
+	m_count = 0U;
+}
+
+void CDMRFanOut::refresh(CDMRFanOutTarget& target, unsigned int srcId, unsigned int dstId, FLCO flco)
+{
+	if (target.m_dstId != 0U) {
+		dstId = target.m_dstId;
+		flco  = target.m_flco;
+	}
+
+	if (!target.m_lc.matches(flco, srcId, dstId, m_colorCode))
+		target.m_lc = m_lcCache.find(flco, srcId, dstId, m_colorCode);
+}
+
+void CDMRFanOut::write(CDMRFanOutTarget& target, unsigned int srcId, unsigned int dstId, FLCO flco, unsigned char dataType, unsigned int seqNo, unsigned int n, const unsigned char* data)
+{
+	if (target.m_dstId != 0U) {
+		dstId = target.m_dstId;
+		flco  = target.m_flco;
+	}
+
+	CDMRData dmrData;
+	dmrData.setSlotNo(m_slotNo);
+	dmrData.setSrcId(srcId);
+	dmrData.setDstId(dstId);
+	dmrData.setFLCO(flco);
+	dmrData.setN(n);
+	dmrData.setSeqNo(seqNo & 0xFFU);
+	dmrData.setBER(0U);
+	dmrData.setRSSI(0U);
+	dmrData.setDataType(dataType);
+	dmrData.setData(data);
+
+	target.m_network->write(dmrData);
+}
@@ -0,0 +1,63 @@
+/*
+*   Copyright (C) 2018 by Andy Uribe CA6JAU
+*
+*   This program is free software; you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation; either version 2 of the License, or
+*   (at your option) any later version.
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program; if not, write to the Free Software
+*   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+*/
+
+#if !defined(DMRFanOut_H)
+#define	DMRFanOut_H
+
+#include "DMRDefines.h"
+#include "DMRNetwork.h"
+#include "DMRLCCache.h"
+
+#include <vector>
+
+class CDMRFanOutTarget {
+public:
+	CDMRFanOutTarget(CDMRNetwork* network, unsigned int dstId, FLCO flco);
+
+	CDMRNetwork*     m_network;
+	unsigned int     m_dstId;	// 0 follows the destination of the YSF stream
+	FLCO             m_flco;
+	CDMRLCCacheEntry m_lc;
+};
+
+// Wraps each frame coming out of a single transcoder into DMRD packets for
+// several masters or talkgroups. Only the LC differs between the targets,
+// the AMBE is shared, and each master keeps its own stream id.
+class CDMRFanOut {
+public:
+	CDMRFanOut(unsigned int slotNo, unsigned char colorCode);
+	~CDMRFanOut();
+
+	void add(CDMRNetwork* network, unsigned int dstId, FLCO flco);
+
+	void writeHeader(unsigned int srcId, unsigned int dstId, FLCO flco);
+	void writeData(unsigned int srcId, unsigned int dstId, FLCO flco, const unsigned char* data);
+	void writeTerminator(unsigned int srcId, unsigned int dstId, FLCO flco);
+
+private:
+	unsigned int                  m_slotNo;
+	unsigned char                 m_colorCode;
+	CDMRLCCache                   m_lcCache;
+	std::vector<CDMRFanOutTarget> m_targets;
+	unsigned int                  m_count;
+
+	void refresh(CDMRFanOutTarget& target, unsigned int srcId, unsigned int dstId, FLCO flco);
+	void write(CDMRFanOutTarget& target, unsigned int srcId, unsigned int dstId, FLCO flco, unsigned char dataType, unsigned int seqNo, unsigned int n, const unsigned char* data);
+};
+
+#endif
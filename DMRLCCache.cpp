@@ -0,0 +1,184 @@
+/*
+*   Copyright (C) 2018 by Andy Uribe CA6JAU
+*
+*   This program is free software; you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation; either version 2 of the License, or
+*   (at your option) any later version.
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program; if not, write to the Free Software
+*   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+*/
+
+#include "DMRLCCache.h"
+
+#include "DMREmbeddedData.h"
+#include "DMRSlotType.h"
+#include "DMRFullLC.h"
+#include "DMREMB.h"
+#include "DMRLC.h"
+#include "Sync.h"
+
+#include <cstdio>
+#include <cassert>
+#include <cstring>
+
+CDMRLCCacheEntry::CDMRLCCacheEntry() :
+m_flco(FLCO_GROUP),
+m_srcId(0U),
+m_dstId(0U),
+m_colorCode(0U),
+m_used(0U)
+{
+	::memset(m_header, 0x00U, DMR_FRAME_LENGTH_BYTES);
+	::memset(m_terminator, 0x00U, DMR_FRAME_LENGTH_BYTES);
+	::memset(m_embedded, 0x00U, 5U * 7U);
+}
+
+void CDMRLCCacheEntry::getHeader(unsigned char* data, bool duplex) const
+{
+	assert(data != NULL);
+
+	::memcpy(data, m_header, DMR_FRAME_LENGTH_BYTES);
+
+	CSync::addDMRDataSync(data, duplex);
+}
+
+void CDMRLCCacheEntry::getTerminator(unsigned char* data, bool duplex) const
+{
+	assert(data != NULL);
+
+	::memcpy(data, m_terminator, DMR_FRAME_LENGTH_BYTES);
+
+	CSync::addDMRDataSync(data, duplex);
+}
+
+// Overlay the EMB and embedded LC fragment for voice frame n (1 to 5) onto an AMBE burst
+void CDMRLCCacheEntry::getEmbeddedData(unsigned char* data, unsigned char n) const
+{
+	assert(data != NULL);
+	assert(n >= 1U && n <= 5U);
+
+	const unsigned char* embedded = m_embedded[n - 1U];
+
+	data[13U] = (data[13U] & 0xF0U) | embedded[0U];
+	data[14U] = embedded[1U];
+	data[15U] = embedded[2U];
+	data[16U] = embedded[3U];
+	data[17U] = embedded[4U];
+	data[18U] = embedded[5U];
+	data[19U] = (data[19U] & 0x0FU) | embedded[6U];
+}
+
+bool CDMRLCCacheEntry::matches(FLCO flco, unsigned int srcId, unsigned int dstId, unsigned char colorCode) const
+{
+	return m_used != 0U && m_flco == flco && m_srcId == srcId && m_dstId == dstId && m_colorCode == colorCode;
+}
+
+CDMRLCCache::CDMRLCCache(unsigned int size) :
+m_entries(NULL),
+m_size(size),
+m_count(0U),
+m_last(0U),
+m_clock(0U)
+{
+	assert(size > 0U);
+
+	m_entries = new CDMRLCCacheEntry[size];
+}
+
+CDMRLCCache::~CDMRLCCache()
+{
+	delete[] m_entries;
+}
+
+const CDMRLCCacheEntry& CDMRLCCache::find(FLCO flco, unsigned int srcId, unsigned int dstId, unsigned char colorCode)
+{
+	m_clock++;
+
+	// Most calls are for the stream that is already running
+	if (m_entries[m_last].matches(flco, srcId, dstId, colorCode)) {
+		m_entries[m_last].m_used = m_clock;
+		return m_entries[m_last];
+	}
+
+	unsigned int oldest = 0U;
+	for (unsigned int i = 0U; i < m_count; i++) {
+		if (m_entries[i].matches(flco, srcId, dstId, colorCode)) {
+			m_entries[i].m_used = m_clock;
+			m_last = i;
+			return m_entries[i];
+		}
+
+		if (m_entries[i].m_used < m_entries[oldest].m_used)
+			oldest = i;
+	}
+
+	// Not found, use a free slot or replace the least recently used one
+	unsigned int n = oldest;
+	if (m_count < m_size)
+		n = m_count++;
+
+	encode(m_entries[n], flco, srcId, dstId, colorCode);
+
+	m_entries[n].m_used = m_clock;
+	m_last = n;
+
+	return m_entries[n];
+}
+
+void CDMRLCCache::encode(CDMRLCCacheEntry& entry, FLCO flco, unsigned int srcId, unsigned int dstId, unsigned char colorCode) const
+{
+	entry.m_flco      = flco;
+	entry.m_srcId     = srcId;
+	entry.m_dstId     = dstId;
+	entry.m_colorCode = colorCode;
+
+	CDMRLC lc(flco, srcId, dstId);
+
+	CDMRSlotType slotType;
+	slotType.setColorCode(colorCode);
+
+	CDMRFullLC fullLC;
+
+	::memset(entry.m_header, 0x00U, DMR_FRAME_LENGTH_BYTES);
+	slotType.setDataType(DT_VOICE_LC_HEADER);
+	slotType.getData(entry.m_header);
+	fullLC.encode(lc, entry.m_header, DT_VOICE_LC_HEADER);
+
+	::memset(entry.m_terminator, 0x00U, DMR_FRAME_LENGTH_BYTES);
+	slotType.setDataType(DT_TERMINATOR_WITH_LC);
+	slotType.getData(entry.m_terminator);
+	fullLC.encode(lc, entry.m_terminator, DT_TERMINATOR_WITH_LC);
+
+	CDMREmbeddedData embeddedLC;
+	embeddedLC.setLC(lc);
+
+	CDMREMB emb;
+	emb.setColorCode(colorCode);
+
+	for (unsigned char n = 1U; n <= 5U; n++) {
+		unsigned char frame[DMR_FRAME_LENGTH_BYTES];
+		::memset(frame, 0x00U, DMR_FRAME_LENGTH_BYTES);
+
+		unsigned char lcss = embeddedLC.getData(frame, n);
+
+		emb.setLCSS(lcss);
+		emb.getData(frame);
+
+		unsigned char* embedded = entry.m_embedded[n - 1U];
+		embedded[0U] = frame[13U] & 0x0FU;
+		embedded[1U] = frame[14U];
+		embedded[2U] = frame[15U];
+		embedded[3U] = frame[16U];
+		embedded[4U] = frame[17U];
+		embedded[5U] = frame[18U];
+		embedded[6U] = frame[19U] & 0xF0U;
+	}
+}
@@ -0,0 +1,66 @@
+/*
+*   Copyright (C) 2018 by Andy Uribe CA6JAU
+*
+*   This program is free software; you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation; either version 2 of the License, or
+*   (at your option) any later version.
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program; if not, write to the Free Software
+*   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+*/
+
+#if !defined(DMRLCCache_H)
+#define	DMRLCCache_H
+
+#include "DMRDefines.h"
+
+// Pre-encoded LC material for one (FLCO, src, dst, colour code) tuple. The
+// header and terminator are complete bursts without the sync pattern, the
+// embedded table holds bytes 13-19 (EMB plus embedded LC) for voice frames
+// B to F of a superframe.
+class CDMRLCCacheEntry {
+public:
+	CDMRLCCacheEntry();
+
+	void getHeader(unsigned char* data, bool duplex) const;
+	void getTerminator(unsigned char* data, bool duplex) const;
+
+	void getEmbeddedData(unsigned char* data, unsigned char n) const;
+
+	bool matches(FLCO flco, unsigned int srcId, unsigned int dstId, unsigned char colorCode) const;
+
+	FLCO          m_flco;
+	unsigned int  m_srcId;
+	unsigned int  m_dstId;
+	unsigned char m_colorCode;
+	unsigned char m_header[DMR_FRAME_LENGTH_BYTES];
+	unsigned char m_terminator[DMR_FRAME_LENGTH_BYTES];
+	unsigned char m_embedded[5U][7U];
+	unsigned int  m_used;
+};
+
+class CDMRLCCache {
+public:
+	CDMRLCCache(unsigned int size);
+	~CDMRLCCache();
+
+	const CDMRLCCacheEntry& find(FLCO flco, unsigned int srcId, unsigned int dstId, unsigned char colorCode);
+
+private:
+	CDMRLCCacheEntry* m_entries;
+	unsigned int      m_size;
+	unsigned int      m_count;
+	unsigned int      m_last;
+	unsigned int      m_clock;
+
+	void encode(CDMRLCCacheEntry& entry, FLCO flco, unsigned int srcId, unsigned int dstId, unsigned char colorCode) const;
+};
+
+#endif
@@ -18,22 +18,21 @@
 */
 
 #include "DMRLookup.h"
-#include "Timer.h"
 #include "Log.h"
 
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
 #include <cctype>
+#include <cassert>
 
-CDMRLookup::CDMRLookup(const std::string& filename, unsigned int reloadTime) :
-CThread(),
+CDMRLookup::CDMRLookup(const std::string& filename) :
 m_filename(filename),
-m_reloadTime(reloadTime),
 m_table(),
-m_cstable(),
-m_mutex(),
-m_stop(false)
+m_csKeys(),
+m_csIds(),
+m_csMask(0U),
+m_mutex()
 {
 }
 
@@ -43,44 +42,20 @@ CDMRLookup::~CDMRLookup()
 
 bool CDMRLookup::read()
 {
-	bool ret = load();
-
-	if (m_reloadTime > 0U)
-		run();
-
-	return ret;
+	return load();
 }
 
-void CDMRLookup::entry()
+// The new file is loaded through the file watcher, not by the caller
+void CDMRLookup::setFile(const std::string& filename)
 {
-	LogInfo("Started the DMR Id lookup reload thread");
-
-	CTimer timer(1U, 3600U * m_reloadTime);
-	timer.start();
-
-	while (!m_stop) {
-		sleep(1000U);
-
-		timer.clock();
-		if (timer.hasExpired()) {
-			load();
-			timer.start();
-		}
-	}
-
-	LogInfo("Stopped the DMR Id lookup reload thread");
+	m_mutex.lock();
+	m_filename = filename;
+	m_mutex.unlock();
 }
 
-void CDMRLookup::stop()
+void CDMRLookup::fileChanged(const std::string&)
 {
-	if (m_reloadTime == 0U) {
-		delete this;
-		return;
-	}
-
-	m_stop = true;
-
-	wait();
+	load();
 }
 
 std::string CDMRLookup::findCS(unsigned int id)
@@ -105,16 +80,28 @@ std::string CDMRLookup::findCS(unsigned int id)
 	return callsign;
 }
 
-unsigned int CDMRLookup::findID(std::string cs)
+unsigned int CDMRLookup::findID(const char* callsign, unsigned int length)
 {
-	unsigned int dmrID;
+	assert(callsign != NULL);
+
+	unsigned long long key = callsignKey(callsign, length);
+	if (key == 0ULL)
+		return 0U;
+
+	unsigned int dmrID = 0U;
 
 	m_mutex.lock();
 
-	try {
-		dmrID = m_cstable.at(cs);
-	} catch (...) {
-		dmrID = 0U;
+	if (!m_csKeys.empty()) {
+		unsigned int slot = callsignSlot(key, m_csMask);
+		while (m_csKeys[slot] != 0ULL) {
+			if (m_csKeys[slot] == key) {
+				dmrID = m_csIds[slot];
+				break;
+			}
+
+			slot = (slot + 1U) & m_csMask;
+		}
 	}
 
 	m_mutex.unlock();
@@ -122,6 +109,11 @@ unsigned int CDMRLookup::findID(std::string cs)
 	return dmrID;
 }
 
+unsigned int CDMRLookup::findID(const std::string& callsign)
+{
+	return findID(callsign.c_str(), callsign.length());
+}
+
 bool CDMRLookup::exists(unsigned int id)
 {
 	m_mutex.lock();
@@ -133,19 +125,22 @@ bool CDMRLookup::exists(unsigned int id)
 	return found;
 }
 
+// The new tables are built aside and swapped in, so that the lookups made
+// by the voice threads never wait on the file being read
 bool CDMRLookup::load()
 {
-	FILE* fp = ::fopen(m_filename.c_str(), "rt");
+	m_mutex.lock();
+	std::string filename = m_filename;
+	m_mutex.unlock();
+
+	FILE* fp = ::fopen(filename.c_str(), "rt");
 	if (fp == NULL) {
-		LogWarning("Cannot open the Id lookup file - %s", m_filename.c_str());
+		LogWarning("Cannot open the Id lookup file - %s", filename.c_str());
 		return false;
 	}
 
-	m_mutex.lock();
-
-	// Remove the old entries
-	m_table.clear();
-	m_cstable.clear();
+	std::unordered_map<unsigned int, std::string> table;
+	std::vector<std::pair<unsigned long long, unsigned int> > callsigns;
 
 	char buffer[100U];
 	while (::fgets(buffer, 100U, fp) != NULL) {
@@ -160,20 +155,94 @@ bool CDMRLookup::load()
 			for (char* p = p2; *p != 0x00U; p++)
 				*p = ::toupper(*p);
 
-			m_table[id] = std::string(p2);
-			m_cstable[p2] = id;
+			table[id] = std::string(p2);
+
+			unsigned long long key = callsignKey(p2, ::strlen(p2));
+			if (key != 0ULL)
+				callsigns.push_back(std::make_pair(key, id));
 		}
 	}
 
-	m_mutex.unlock();
-
 	::fclose(fp);
 
-	size_t size = m_table.size();
+	// No more than three quarters full, so that a probe ends quickly
+	unsigned int slots = 1024U;
+	while (slots < callsigns.size() + callsigns.size() / 3U)
+		slots *= 2U;
+
+	std::vector<unsigned long long> csKeys(slots, 0ULL);
+	std::vector<unsigned int> csIds(slots, 0U);
+	unsigned int csMask = slots - 1U;
+
+	// A callsign with more than one id keeps the last, as before
+	for (std::vector<std::pair<unsigned long long, unsigned int> >::const_iterator it = callsigns.begin(); it != callsigns.end(); ++it) {
+		unsigned int slot = callsignSlot(it->first, csMask);
+		while (csKeys[slot] != 0ULL && csKeys[slot] != it->first)
+			slot = (slot + 1U) & csMask;
+
+		csKeys[slot] = it->first;
+		csIds[slot]  = it->second;
+	}
+
+	size_t size = table.size();
+
+	m_mutex.lock();
+	m_table.swap(table);
+	m_csKeys.swap(csKeys);
+	m_csIds.swap(csIds);
+	m_csMask = csMask;
+	m_mutex.unlock();
+
 	if (size == 0U)
 		return false;
 
 	LogInfo("Loaded %u Ids to the callsign lookup table", size);
 
 	return true;
-}
\ No newline at end of file
+}
+
+// A callsign of up to twelve letters and digits, in base 37 with no digit
+// of 0 so that the length is part of the key. Anything else gives 0.
+unsigned long long CDMRLookup::callsignKey(const char* callsign, unsigned int length)
+{
+	assert(callsign != NULL);
+
+	unsigned int i = 0U;
+	while (i < length && callsign[i] == ' ')
+		i++;
+
+	unsigned long long key = 0ULL;
+	unsigned int n = 0U;
+
+	for (; i < length; i++) {
+		char c = callsign[i];
+		if (c == 0x00 || c == ' ' || c == '-' || c == '/')
+			break;
+
+		unsigned int digit;
+		if (c >= '0' && c <= '9')
+			digit = c - '0' + 1U;
+		else if (c >= 'A' && c <= 'Z')
+			digit = c - 'A' + 11U;
+		else if (c >= 'a' && c <= 'z')
+			digit = c - 'a' + 11U;
+		else
+			return 0ULL;
+
+		if (++n > 12U)
+			return 0ULL;
+
+		key = key * 37ULL + digit;
+	}
+
+	return key;
+}
+
+unsigned int CDMRLookup::callsignSlot(unsigned long long key, unsigned int mask)
+{
+	key ^= key >> 33;
+	key *= 0xFF51AFD7ED558CCDULL;
+	key ^= key >> 33;
+
+	return (unsigned int)key & mask;
+}
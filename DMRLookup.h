@@ -20,37 +20,45 @@
 #ifndef	DMRLookup_H
 #define	DMRLookup_H
 
-#include "Thread.h"
+#include "FileWatcher.h"
 #include "Mutex.h"
 
 #include <string>
 #include <unordered_map>
+#include <vector>
 
-class CDMRLookup : public CThread {
+// Loaded again by the file watcher whenever the file changes
+class CDMRLookup : public CFileListener {
 public:
-	CDMRLookup(const std::string& filename, unsigned int reloadTime);
+	CDMRLookup(const std::string& filename);
 	virtual ~CDMRLookup();
 
 	bool read();
 
-	virtual void entry();
+	void setFile(const std::string& filename);
+
+	virtual void fileChanged(const std::string& fileName);
 
 	std::string findCS(unsigned int id);
-	unsigned int findID(std::string cs);
 
-	bool exists(unsigned int id);
+	// Any leading spaces and a suffix after a '-', '/' or space are ignored
+	unsigned int findID(const char* callsign, unsigned int length);
+	unsigned int findID(const std::string& callsign);
 
-	void stop();
+	bool exists(unsigned int id);
 
 private:
 	std::string                                   m_filename;
-	unsigned int                                  m_reloadTime;
 	std::unordered_map<unsigned int, std::string> m_table;
-	std::unordered_map<std::string, unsigned int> m_cstable;
+	std::vector<unsigned long long>               m_csKeys;	// Open addressed on callsignKey(), 0 for an empty slot
+	std::vector<unsigned int>                     m_csIds;
+	unsigned int                                  m_csMask;
 	CMutex                                        m_mutex;
-	bool                                          m_stop;
 
 	bool load();
+
+	static unsigned long long callsignKey(const char* callsign, unsigned int length);
+	static unsigned int callsignSlot(unsigned long long key, unsigned int mask);
 };
 
 #endif
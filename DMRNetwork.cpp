@@ -19,6 +19,7 @@
 #include "DMRNetwork.h"
 
 #include "StopWatch.h"
+#include "Resolver.h"
 #include "SHA256.h"
 #include "Utils.h"
 #include "Log.h"
@@ -31,7 +32,50 @@ const unsigned int BUFFER_LENGTH = 500U;
 
 const unsigned int HOMEBREW_DATA_PACKET_LENGTH = 55U;
 
+// With masters to fail over to, a silent master is given up on sooner
+const unsigned int PING_TIME          = 10U;
+const unsigned int TIMEOUT_TIME       = 60U;
+const unsigned int FAILOVER_PING_TIME = 5U;
+const unsigned int FAILOVER_TIMEOUT   = 15U;
+
+const unsigned int PROBE_TIME         = 30U;
+
+// Reconnection delays double from the first to the last, in ms
+const unsigned int BACKOFF_FIRST = 250U;
+const unsigned int BACKOFF_LAST  = 60000U;
+
+const unsigned int NO_MASTER = 0xFFFFFFFFU;
+
+// Streams received at once, a stream beyond these is dropped
+const unsigned int STREAM_BUFFERS = 8U;
+
+// Longer than the stream watchdog, so normally the stream is ended first
+const unsigned int STREAM_IDLE_TIME = 3000U;
+
+CDMRMaster::CDMRMaster(const std::string& hostName, unsigned int port) :
+m_hostName(hostName),
+m_port(port),
+m_address(),
+m_healthy(true),
+m_rtt(0U),
+m_probing(false),
+m_probeWatch()
+{
+	m_address.s_addr = INADDR_NONE;
+}
+
+CDMRStreamBuffer::CDMRStreamBuffer(const std::string& name, unsigned int jitter, bool debug) :
+m_buffer(name, HOMEBREW_DATA_PACKET_LENGTH, DMR_SLOT_TIME, jitter, debug),
+m_slotNo(0U),
+m_streamId(0U),
+m_idle(1000U, 0U, STREAM_IDLE_TIME),
+m_used(false)
+{
+}
+
 CDMRNetwork::CDMRNetwork(const std::string& address, unsigned int port, unsigned int local, unsigned int id, const std::string& password, bool duplex, const char* version, bool debug, bool slot1, bool slot2, HW_TYPE hwType, unsigned int jitter) :
+m_masters(),
+m_current(0U),
 m_address(),
 m_port(port),
 m_id(NULL),
@@ -43,11 +87,11 @@ m_socket(local),
 m_enabled(false),
 m_slot1(slot1),
 m_slot2(slot2),
-m_delayBuffers(NULL),
+m_delayBuffers(),
 m_hwType(hwType),
 m_status(WAITING_CONNECT),
-m_retryTimer(1000U, 10U),
-m_timeoutTimer(1000U, 60U),
+m_retryTimer(1000U, PING_TIME),
+m_timeoutTimer(1000U, TIMEOUT_TIME),
 m_buffer(NULL),
 m_salt(NULL),
 m_streamId(NULL),
@@ -63,7 +107,16 @@ m_height(0),
 m_location(),
 m_description(),
 m_url(),
-m_beacon(false)
+m_beacon(false),
+m_mutex(),
+m_socketOpen(false),
+m_failures(0U),
+m_probeTimer(1000U, PROBE_TIME),
+m_standbyEnabled(false),
+m_standby(NO_MASTER),
+m_standbyStatus(WAITING_CONNECT),
+m_standbyRetryTimer(1000U, FAILOVER_PING_TIME),
+m_standbyTimeoutTimer(1000U, FAILOVER_TIMEOUT)
 {
 	assert(!address.empty());
 	assert(port > 0U);
@@ -71,17 +124,21 @@ m_beacon(false)
 	assert(!password.empty());
 	assert(jitter > 0U);
 
-	m_address = CUDPSocket::lookup(address);
+	m_masters.push_back(CDMRMaster(address, port));
+
+	// Only starts the lookup, the address is picked up when connecting
+	CResolver::lookup(address, m_masters[0U].m_address);
 
 	m_buffer        = new unsigned char[BUFFER_LENGTH];
 	m_salt          = new unsigned char[sizeof(uint32_t)];
 	m_id            = new uint8_t[4U];
 	m_streamId      = new uint32_t[2U];
 
-	m_delayBuffers  = new CDelayBuffer*[3U];
-
-	m_delayBuffers[1U] = new CDelayBuffer("DMR Slot 1", HOMEBREW_DATA_PACKET_LENGTH, DMR_SLOT_TIME, jitter, debug);
-	m_delayBuffers[2U] = new CDelayBuffer("DMR Slot 2", HOMEBREW_DATA_PACKET_LENGTH, DMR_SLOT_TIME, jitter, debug);
+	for (unsigned int i = 0U; i < STREAM_BUFFERS; i++) {
+		char name[20U];
+		::sprintf(name, "DMR Stream %u", i + 1U);
+		m_delayBuffers.push_back(new CDMRStreamBuffer(name, jitter, debug));
+	}
 
 	m_id[0U] = id >> 24;
 	m_id[1U] = id >> 16;
@@ -97,15 +154,13 @@ m_beacon(false)
 
 CDMRNetwork::~CDMRNetwork()
 {
-	delete m_delayBuffers[1U];
-	delete m_delayBuffers[2U];
+	for (std::vector<CDMRStreamBuffer*>::iterator it = m_delayBuffers.begin(); it != m_delayBuffers.end(); ++it)
+		delete *it;
 
 	delete[] m_buffer;
 	delete[] m_salt;
 	delete[] m_streamId;
 	delete[] m_id;
-
-	delete[] m_delayBuffers;
 }
 
 void CDMRNetwork::setOptions(const std::string& options)
@@ -113,6 +168,74 @@ void CDMRNetwork::setOptions(const std::string& options)
 	m_options = options;
 }
 
+void CDMRNetwork::addMaster(const std::string& address, unsigned int port)
+{
+	assert(!address.empty());
+	assert(port > 0U);
+
+	m_masters.push_back(CDMRMaster(address, port));
+	CResolver::lookup(address, m_masters.back().m_address);
+
+	m_retryTimer.setTimeout(FAILOVER_PING_TIME);
+	m_timeoutTimer.setTimeout(FAILOVER_TIMEOUT);
+	m_probeTimer.start();
+}
+
+void CDMRNetwork::setStandby(bool standby)
+{
+	m_standbyEnabled = standby;
+}
+
+// Replaces the first master, logging out of whichever master is in use and into
+// the new one at once. The other masters and the streams being received are kept.
+void CDMRNetwork::setMaster(const std::string& address, unsigned int port, const std::string& password, const std::string& options)
+{
+	assert(!address.empty());
+	assert(port > 0U);
+	assert(!password.empty());
+
+	m_mutex.lock();
+
+	unsigned char buffer[9U];
+	::memcpy(buffer + 0U, "RPTCL", 5U);
+	::memcpy(buffer + 5U, m_id, 4U);
+
+	if (m_status == RUNNING)
+		write(buffer, 9U);
+
+	if (m_standbyStatus == RUNNING)
+		write(m_masters[m_standby], buffer, 9U);
+
+	dropStandby();
+
+	m_masters[0U] = CDMRMaster(address, port);
+	CResolver::lookup(address, m_masters[0U].m_address);
+
+	m_password = password;
+	m_options  = options;
+
+	m_current  = 0U;
+	m_failures = 0U;
+
+	LogMessage("DMR, Connecting to the master %s:%u", address.c_str(), port);
+
+	m_status = WAITING_CONNECT;
+	m_timeoutTimer.stop();
+	m_retryTimer.start(0U, BACKOFF_FIRST);
+
+	m_mutex.unlock();
+}
+
+void CDMRNetwork::setJitter(unsigned int jitter)
+{
+	assert(jitter > 0U);
+
+	m_mutex.lock();
+	for (std::vector<CDMRStreamBuffer*>::iterator it = m_delayBuffers.begin(); it != m_delayBuffers.end(); ++it)
+		(*it)->m_buffer.setJitter(jitter);
+	m_mutex.unlock();
+}
+
 void CDMRNetwork::setConfig(const std::string& callsign, unsigned int rxFrequency, unsigned int txFrequency, unsigned int power, unsigned int colorCode, float latitude, float longitude, int height, const std::string& location, const std::string& description, const std::string& url)
 {
 	m_callsign    = callsign;
@@ -149,11 +272,17 @@ bool CDMRNetwork::read(CDMRData& data)
 	if (m_status != RUNNING)
 		return false;
 
-	for (unsigned int slotNo = 1U; slotNo <= 2U; slotNo++) {
+	m_mutex.lock();
+
+	for (std::vector<CDMRStreamBuffer*>::iterator it = m_delayBuffers.begin(); it != m_delayBuffers.end(); ++it) {
+		if (!(*it)->m_used)
+			continue;
+
+		unsigned int slotNo = (*it)->m_slotNo;
 		unsigned int length = 0U;
 		B_STATUS status = BS_NO_DATA;
 
-		status = m_delayBuffers[slotNo]->getData(m_buffer, length);
+		status = (*it)->m_buffer.getData(m_buffer, length);
 
 		if (status != BS_NO_DATA) {
 			unsigned char seqNo = m_buffer[4U];
@@ -164,12 +293,19 @@ bool CDMRNetwork::read(CDMRData& data)
 
 			FLCO flco = (m_buffer[15U] & 0x40U) == 0x40U ? FLCO_USER_USER : FLCO_GROUP;
 
+			unsigned int streamId = (m_buffer[16U] << 24) | (m_buffer[17U] << 16) | (m_buffer[18U] << 8) | (m_buffer[19U] << 0);
+
 			data.setSeqNo(seqNo);
 			data.setSlotNo(slotNo);
 			data.setSrcId(srcId);
 			data.setDstId(dstId);
 			data.setFLCO(flco);
 			data.setMissing(status == BS_MISSING);
+			data.setStreamId(streamId);
+
+			// Not every master sends the BER and RSSI on the end
+			if (length >= HOMEBREW_DATA_PACKET_LENGTH)
+				data.setBER(m_buffer[53U]);
 
 			bool dataSync = (m_buffer[15U] & 0x20U) == 0x20U;
 			bool voiceSync = (m_buffer[15U] & 0x10U) == 0x10U;
@@ -190,10 +326,14 @@ bool CDMRNetwork::read(CDMRData& data)
 				data.setN(n);
 			}
 
+			m_mutex.unlock();
+
 			return true;
 		}
 	}
 
+	m_mutex.unlock();
+
 	return false;
 }
 
@@ -253,8 +393,6 @@ bool CDMRNetwork::write(const CDMRData& data)
 
 	buffer[4U] = data.getSeqNo();
 
-	::memcpy(buffer + 16U, m_streamId + slotIndex, 4U);
-
 	data.getData(buffer + 20U);
 
 	buffer[53U] = data.getBER();
@@ -264,9 +402,15 @@ bool CDMRNetwork::write(const CDMRData& data)
 	if (m_debug)
 		CUtils::dump(1U, "Network Transmitted", buffer, HOMEBREW_DATA_PACKET_LENGTH);
 
+	m_mutex.lock();
+
+	::memcpy(buffer + 16U, m_streamId + slotIndex, 4U);
+
 	for (unsigned int i = 0U; i < count; i++)
 		write(buffer, HOMEBREW_DATA_PACKET_LENGTH);
 
+	m_mutex.unlock();
+
 	return true;
 }
 
@@ -287,7 +431,11 @@ bool CDMRNetwork::writePosition(unsigned int id, const unsigned char* data)
 
 	::memcpy(buffer + 11U, data + 2U, 7U);
 
-	return write(buffer, 18U);
+	m_mutex.lock();
+	bool ret = write(buffer, 18U);
+	m_mutex.unlock();
+
+	return ret;
 }
 
 bool CDMRNetwork::writeTalkerAlias(unsigned int id, unsigned char type, const unsigned char* data)
@@ -309,21 +457,31 @@ bool CDMRNetwork::writeTalkerAlias(unsigned int id, unsigned char type, const un
 
 	::memcpy(buffer + 12U, data + 2U, 7U);
 
-	return write(buffer, 19U);
+	m_mutex.lock();
+	bool ret = write(buffer, 19U);
+	m_mutex.unlock();
+
+	return ret;
 }
 
 void CDMRNetwork::close()
 {
 	LogMessage("DMR, Closing DMR Network");
 
-	if (m_status == RUNNING) {
-		unsigned char buffer[9U];
-		::memcpy(buffer + 0U, "RPTCL", 5U);
-		::memcpy(buffer + 5U, m_id, 4U);
+	unsigned char buffer[9U];
+	::memcpy(buffer + 0U, "RPTCL", 5U);
+	::memcpy(buffer + 5U, m_id, 4U);
+
+	if (m_status == RUNNING)
 		write(buffer, 9U);
-	}
+
+	if (m_standbyStatus == RUNNING)
+		write(m_masters[m_standby], buffer, 9U);
+
+	dropStandby();
 
 	m_socket.close();
+	m_socketOpen = false;
 
 	m_retryTimer.stop();
 	m_timeoutTimer.stop();
@@ -331,15 +489,48 @@ void CDMRNetwork::close()
 
 void CDMRNetwork::clock(unsigned int ms)
 {
-	m_delayBuffers[1U]->clock(ms);
-	m_delayBuffers[2U]->clock(ms);
+	m_mutex.lock();
+	clockNetwork(ms);
+	m_mutex.unlock();
+}
+
+void CDMRNetwork::clockNetwork(unsigned int ms)
+{
+	for (std::vector<CDMRStreamBuffer*>::iterator it = m_delayBuffers.begin(); it != m_delayBuffers.end(); ++it) {
+		CDMRStreamBuffer* buffer = *it;
+		if (!buffer->m_used)
+			continue;
+
+		buffer->m_buffer.clock(ms);
+
+		buffer->m_idle.clock(ms);
+		if (buffer->m_idle.hasExpired()) {
+			buffer->m_buffer.reset();
+			buffer->m_idle.stop();
+			buffer->m_used = false;
+		}
+	}
 
 	if (m_status == WAITING_CONNECT) {
 		m_retryTimer.clock(ms);
 		if (m_retryTimer.isRunning() && m_retryTimer.hasExpired()) {
-			bool ret = m_socket.open();
-			if (ret) {
-				ret = writeLogin();
+			CDMRMaster& master = m_masters[m_current];
+
+			// Every (re)connection uses the latest address, without waiting for it
+			if (!CResolver::lookup(master.m_hostName, master.m_address)) {
+				LogWarning("DMR, No address for %s yet, retrying", master.m_hostName.c_str());
+				m_retryTimer.start();
+				return;
+			}
+
+			m_address = master.m_address;
+			m_port    = master.m_port;
+
+			if (!m_socketOpen)
+				m_socketOpen = m_socket.open();
+
+			if (m_socketOpen) {
+				bool ret = writeLogin(master);
 				if (!ret)
 					return;
 
@@ -347,7 +538,8 @@ void CDMRNetwork::clock(unsigned int ms)
 				m_timeoutTimer.start();
 			}
 
-			m_retryTimer.start();
+			// Back to the ping interval after any backoff delay
+			m_retryTimer.start(m_masters.size() > 1U ? FAILOVER_PING_TIME : PING_TIME);
 		}
 
 		return;
@@ -358,8 +550,10 @@ void CDMRNetwork::clock(unsigned int ms)
 	int length = m_socket.read(m_buffer, BUFFER_LENGTH, address, port);
 	if (length < 0) {
 		LogError("DMR, Socket has failed, retrying connection to the master");
-		close();
-		open();
+		m_socket.close();
+		m_socketOpen = false;
+		dropStandby();
+		failover();
 		return;
 	}
 
@@ -384,52 +578,23 @@ void CDMRNetwork::clock(unsigned int ms)
 				   the Network sometimes times out and reaches here.
 				   We want it to reconnect so... */
 				LogError("DMR, Login to the master has failed, retrying network ...");
-				close();
-				open();
+				failover();
 				return;
 			}
 		} else if (::memcmp(m_buffer, "RPTACK",  6U) == 0) {
-			switch (m_status) {
-				case WAITING_LOGIN:
-					LogDebug("DMR, Sending authorisation");
-					::memcpy(m_salt, m_buffer + 6U, sizeof(uint32_t));
-					writeAuthorisation();
-					m_status = WAITING_AUTHORISATION;
-					m_timeoutTimer.start();
-					m_retryTimer.start();
-					break;
-				case WAITING_AUTHORISATION:
-					LogDebug("DMR, Sending configuration");
-					writeConfig();
-					m_status = WAITING_CONFIG;
-					m_timeoutTimer.start();
-					m_retryTimer.start();
-					break;
-				case WAITING_CONFIG:
-					if (m_options.empty()) {
-						LogMessage("DMR, Logged into the master successfully");
-						m_status = RUNNING;
-					} else {
-						LogDebug("DMR, Sending options");
-						writeOptions();
-						m_status = WAITING_OPTIONS;
-					}
-					m_timeoutTimer.start();
-					m_retryTimer.start();
-					break;
-				case WAITING_OPTIONS:
+			if (m_status != RUNNING) {
+				if (login(m_status, m_masters[m_current], m_salt, m_buffer)) {
 					LogMessage("DMR, Logged into the master successfully");
-					m_status = RUNNING;
-					m_timeoutTimer.start();
-					m_retryTimer.start();
-					break;
-				default:
-					break;
+					m_failures = 0U;
+				}
+
+				m_timeoutTimer.start();
+				m_retryTimer.start();
 			}
 		} else if (::memcmp(m_buffer, "MSTCL",   5U) == 0) {
 			LogError("DMR, Master is closing down");
-			close();
-			open();
+			failover();
+			return;
 		} else if (::memcmp(m_buffer, "MSTPONG", 7U) == 0) {
 			m_timeoutTimer.start();
 		} else if (::memcmp(m_buffer, "RPTSBKN", 7U) == 0) {
@@ -437,25 +602,31 @@ void CDMRNetwork::clock(unsigned int ms)
 		} else {
 			CUtils::dump("Unknown packet from the master", m_buffer, length);
 		}
+	} else if (length > 0) {
+		int index = findMaster(address, port);
+		if (index >= 0)
+			receiveOther((unsigned int)index, m_buffer, length);
 	}
 
 	m_retryTimer.clock(ms);
 	if (m_retryTimer.isRunning() && m_retryTimer.hasExpired()) {
+		const CDMRMaster& master = m_masters[m_current];
+
 		switch (m_status) {
 			case WAITING_LOGIN:
-				writeLogin();
+				writeLogin(master);
 				break;
 			case WAITING_AUTHORISATION:
-				writeAuthorisation();
+				writeAuthorisation(master, m_salt);
 				break;
 			case WAITING_OPTIONS:
-				writeOptions();
+				writeOptions(master);
 				break;
 			case WAITING_CONFIG:
-				writeConfig();
+				writeConfig(master);
 				break;
 			case RUNNING:
-				writePing();
+				writePing(master);
 				break;
 			default:
 				break;
@@ -467,22 +638,295 @@ void CDMRNetwork::clock(unsigned int ms)
 	m_timeoutTimer.clock(ms);
 	if (m_timeoutTimer.isRunning() && m_timeoutTimer.hasExpired()) {
 		LogError("DMR, Connection to the master has timed out, retrying connection");
-		close();
-		open();
+		failover();
+		return;
+	}
+
+	clockProbes(ms);
+	clockStandby(ms);
+}
+
+// Steps through the login on each RPTACK, returns true once it is complete
+bool CDMRNetwork::login(STATUS& status, const CDMRMaster& master, unsigned char* salt, const unsigned char* ack)
+{
+	switch (status) {
+		case WAITING_LOGIN:
+			LogDebug("DMR, Sending authorisation");
+			::memcpy(salt, ack + 6U, sizeof(uint32_t));
+			writeAuthorisation(master, salt);
+			status = WAITING_AUTHORISATION;
+			return false;
+		case WAITING_AUTHORISATION:
+			LogDebug("DMR, Sending configuration");
+			writeConfig(master);
+			status = WAITING_CONFIG;
+			return false;
+		case WAITING_CONFIG:
+			if (m_options.empty()) {
+				status = RUNNING;
+				return true;
+			}
+
+			LogDebug("DMR, Sending options");
+			writeOptions(master);
+			status = WAITING_OPTIONS;
+			return false;
+		case WAITING_OPTIONS:
+			status = RUNNING;
+			return true;
+		default:
+			return false;
+	}
+}
+
+// Moves to the logged in standby if there is one, otherwise starts logging
+// into the best master after a delay that grows with each failure in a row
+void CDMRNetwork::failover()
+{
+	m_masters[m_current].m_healthy = false;
+
+	if (m_standbyStatus == RUNNING) {
+		m_current = m_standby;
+		m_address = m_masters[m_current].m_address;
+		m_port    = m_masters[m_current].m_port;
+		m_status  = RUNNING;
+
+		m_standby       = NO_MASTER;
+		m_standbyStatus = WAITING_CONNECT;
+		m_standbyRetryTimer.stop();
+		m_standbyTimeoutTimer.stop();
+
+		LogMessage("DMR, Switched to the standby master %s:%u", m_masters[m_current].m_hostName.c_str(), m_port);
+
+		m_failures = 0U;
+		writePing(m_masters[m_current]);
+		m_timeoutTimer.start();
+		m_retryTimer.start();
+		return;
+	}
+
+	dropStandby();
+
+	m_current = selectMaster(m_current);
+
+	unsigned int delay = BACKOFF_FIRST;
+	for (unsigned int i = 0U; i < m_failures && delay < BACKOFF_LAST; i++)
+		delay *= 2U;
+	if (delay > BACKOFF_LAST)
+		delay = BACKOFF_LAST;
+
+	// Up to a quarter either way, so that many clients do not return in step
+	delay = delay - delay / 4U + (unsigned int)::rand() % (delay / 2U + 1U);
+
+	m_failures++;
+
+	LogMessage("DMR, Connecting to the master %s:%u in %ums", m_masters[m_current].m_hostName.c_str(), m_masters[m_current].m_port, delay);
+
+	m_status = WAITING_CONNECT;
+	m_timeoutTimer.stop();
+	m_retryTimer.start(delay / 1000U, delay % 1000U);
+}
+
+// The healthy master with the lowest round trip time, trying the others in
+// turn when none is known to be healthy
+unsigned int CDMRNetwork::selectMaster(unsigned int exclude) const
+{
+	unsigned int best = NO_MASTER;
+
+	for (unsigned int i = 0U; i < m_masters.size(); i++) {
+		if (i == exclude || !m_masters[i].m_healthy)
+			continue;
+
+		if (best == NO_MASTER || m_masters[i].m_rtt < m_masters[best].m_rtt)
+			best = i;
+	}
+
+	if (best != NO_MASTER)
+		return best;
+
+	return (exclude + 1U) % m_masters.size();
+}
+
+int CDMRNetwork::findMaster(const in_addr& address, unsigned int port) const
+{
+	for (unsigned int i = 0U; i < m_masters.size(); i++) {
+		if (m_masters[i].m_address.s_addr == address.s_addr && m_masters[i].m_port == port)
+			return int(i);
+	}
+
+	return -1;
+}
+
+// The other masters are sent a login now and then, any answer shows that they
+// are up and how far away they are
+void CDMRNetwork::clockProbes(unsigned int ms)
+{
+	m_probeTimer.clock(ms);
+	if (!m_probeTimer.isRunning() || !m_probeTimer.hasExpired())
+		return;
+
+	m_probeTimer.start();
+
+	if (m_status != RUNNING)
+		return;
+
+	for (unsigned int i = 0U; i < m_masters.size(); i++) {
+		if (i == m_current || i == m_standby)
+			continue;
+
+		CDMRMaster& master = m_masters[i];
+
+		if (master.m_probing)
+			master.m_healthy = false;
+
+		if (!CResolver::lookup(master.m_hostName, master.m_address))
+			continue;
+
+		master.m_probing = true;
+		master.m_probeWatch.start();
+		writeLogin(master);
+	}
+}
+
+void CDMRNetwork::clockStandby(unsigned int ms)
+{
+	if (!m_standbyEnabled || m_masters.size() < 2U || m_status != RUNNING)
+		return;
+
+	if (m_standby == NO_MASTER) {
+		unsigned int index = selectMaster(m_current);
+		if (index == m_current || !m_masters[index].m_healthy || m_masters[index].m_address.s_addr == INADDR_NONE)
+			return;
+
+		LogMessage("DMR, Logging into %s:%u as the standby master", m_masters[index].m_hostName.c_str(), m_masters[index].m_port);
+
+		m_standby       = index;
+		m_standbyStatus = WAITING_LOGIN;
+		writeLogin(m_masters[m_standby]);
+		m_standbyRetryTimer.start();
+		m_standbyTimeoutTimer.start();
+		return;
+	}
+
+	const CDMRMaster& master = m_masters[m_standby];
+
+	m_standbyRetryTimer.clock(ms);
+	if (m_standbyRetryTimer.isRunning() && m_standbyRetryTimer.hasExpired()) {
+		switch (m_standbyStatus) {
+			case WAITING_LOGIN:
+				writeLogin(master);
+				break;
+			case WAITING_AUTHORISATION:
+				writeAuthorisation(master, m_standbySalt);
+				break;
+			case WAITING_OPTIONS:
+				writeOptions(master);
+				break;
+			case WAITING_CONFIG:
+				writeConfig(master);
+				break;
+			case RUNNING:
+				writePing(master);
+				break;
+			default:
+				break;
+		}
+
+		m_standbyRetryTimer.start();
+	}
+
+	m_standbyTimeoutTimer.clock(ms);
+	if (m_standbyTimeoutTimer.isRunning() && m_standbyTimeoutTimer.hasExpired()) {
+		LogWarning("DMR, The standby master %s:%u has timed out", master.m_hostName.c_str(), master.m_port);
+		m_masters[m_standby].m_healthy = false;
+		dropStandby();
 	}
 }
 
+// Packets from a master other than the one in use, probe answers or the standby login
+void CDMRNetwork::receiveOther(unsigned int index, const unsigned char* data, unsigned int length)
+{
+	CDMRMaster& master = m_masters[index];
+
+	// A short packet must not match on what a longer one left in the buffer
+	bool ack   = length >= 6U && ::memcmp(data, "RPTACK",  6U) == 0;
+	bool nak   = length >= 6U && ::memcmp(data, "MSTNAK",  6U) == 0;
+	bool pong  = length >= 7U && ::memcmp(data, "MSTPONG", 7U) == 0;
+	bool close = length >= 5U && ::memcmp(data, "MSTCL",   5U) == 0;
+
+	if (index == m_standby) {
+		if (ack) {
+			// The answer to the login carries the salt
+			if (m_standbyStatus == WAITING_LOGIN && length < 6U + sizeof(uint32_t))
+				return;
+
+			if (m_standbyStatus != RUNNING && login(m_standbyStatus, master, m_standbySalt, data))
+				LogMessage("DMR, Logged into the standby master successfully");
+			m_standbyTimeoutTimer.start();
+			m_standbyRetryTimer.start();
+		} else if (pong) {
+			m_standbyTimeoutTimer.start();
+		} else if (nak || close) {
+			LogWarning("DMR, The standby master %s:%u has refused us", master.m_hostName.c_str(), master.m_port);
+			master.m_healthy = false;
+			dropStandby();
+		}
+
+		// Its voice traffic is not wanted until it takes over
+		return;
+	}
+
+	if (master.m_probing && (ack || nak)) {
+		master.m_rtt     = master.m_probeWatch.elapsed();
+		master.m_healthy = true;
+		master.m_probing = false;
+
+		LogDebug("DMR, Master %s:%u answered in %ums", master.m_hostName.c_str(), master.m_port, master.m_rtt);
+	}
+}
+
+void CDMRNetwork::dropStandby()
+{
+	m_standby       = NO_MASTER;
+	m_standbyStatus = WAITING_CONNECT;
+	m_standbyRetryTimer.stop();
+	m_standbyTimeoutTimer.stop();
+}
+
+void CDMRNetwork::release(unsigned int streamId)
+{
+	m_mutex.lock();
+
+	for (std::vector<CDMRStreamBuffer*>::iterator it = m_delayBuffers.begin(); it != m_delayBuffers.end(); ++it) {
+		CDMRStreamBuffer* buffer = *it;
+		if (buffer->m_used && buffer->m_streamId == streamId) {
+			buffer->m_buffer.reset();
+			buffer->m_idle.stop();
+			buffer->m_used = false;
+		}
+	}
+
+	m_mutex.unlock();
+}
+
 void CDMRNetwork::reset(unsigned int slotNo)
 {
 	assert(slotNo == 1U || slotNo == 2U);
 
-	if (slotNo == 1U) {
-		m_delayBuffers[1U]->reset();
-		m_streamId[0U] = ::rand() + 1U;
-	} else {
-		m_delayBuffers[2U]->reset();
-		m_streamId[1U] = ::rand() + 1U;
+	m_mutex.lock();
+
+	for (std::vector<CDMRStreamBuffer*>::iterator it = m_delayBuffers.begin(); it != m_delayBuffers.end(); ++it) {
+		CDMRStreamBuffer* buffer = *it;
+		if (buffer->m_used && buffer->m_slotNo == slotNo) {
+			buffer->m_buffer.reset();
+			buffer->m_idle.stop();
+			buffer->m_used = false;
+		}
 	}
+
+	m_streamId[slotNo - 1U] = ::rand() + 1U;
+
+	m_mutex.unlock();
 }
 
 bool CDMRNetwork::isConnected() const
@@ -507,26 +951,56 @@ void CDMRNetwork::receiveData(const unsigned char* data, unsigned int length)
 	if (slotNo == 2U && !m_slot2)
 		return;
 
-	m_delayBuffers[slotNo]->addData(data, length);
+	uint32_t streamId = (data[16U] << 24) | (data[17U] << 16) | (data[18U] << 8) | (data[19U] << 0);
+
+	// Each stream is paced by its own buffer, so that another one on the
+	// slot neither delays it nor has its frames repeated in its place
+	CDMRStreamBuffer* buffer = NULL;
+	CDMRStreamBuffer* unused = NULL;
+	for (std::vector<CDMRStreamBuffer*>::iterator it = m_delayBuffers.begin(); it != m_delayBuffers.end(); ++it) {
+		if (!(*it)->m_used) {
+			if (unused == NULL)
+				unused = *it;
+		} else if ((*it)->m_streamId == streamId && (*it)->m_slotNo == slotNo) {
+			buffer = *it;
+			break;
+		}
+	}
+
+	if (buffer == NULL) {
+		if (unused == NULL) {
+			if (m_debug)
+				LogDebug("DMR, No delay buffer is free for stream %08X on slot %u", streamId, slotNo);
+			return;
+		}
 
+		buffer = unused;
+		buffer->m_buffer.reset();
+		buffer->m_slotNo   = slotNo;
+		buffer->m_streamId = streamId;
+		buffer->m_used     = true;
+	}
+
+	buffer->m_buffer.addData(data, length);
+	buffer->m_idle.start();
 }
 
-bool CDMRNetwork::writeLogin()
+bool CDMRNetwork::writeLogin(const CDMRMaster& master)
 {
 	unsigned char buffer[8U];
 
 	::memcpy(buffer + 0U, "RPTL", 4U);
 	::memcpy(buffer + 4U, m_id, 4U);
 
-	return write(buffer, 8U);
+	return write(master, buffer, 8U);
 }
 
-bool CDMRNetwork::writeAuthorisation()
+bool CDMRNetwork::writeAuthorisation(const CDMRMaster& master, const unsigned char* salt)
 {
 	size_t size = m_password.size();
 
 	unsigned char* in = new unsigned char[size + sizeof(uint32_t)];
-	::memcpy(in, m_salt, sizeof(uint32_t));
+	::memcpy(in, salt, sizeof(uint32_t));
 	for (size_t i = 0U; i < size; i++)
 		in[i + sizeof(uint32_t)] = m_password.at(i);
 
@@ -539,10 +1013,10 @@ bool CDMRNetwork::writeAuthorisation()
 
 	delete[] in;
 
-	return write(out, 40U);
+	return write(master, out, 40U);
 }
 
-bool CDMRNetwork::writeOptions()
+bool CDMRNetwork::writeOptions(const CDMRMaster& master)
 {
 	char buffer[300U];
 
@@ -550,10 +1024,10 @@ bool CDMRNetwork::writeOptions()
 	::memcpy(buffer + 4U, m_id, 4U);
 	::strcpy(buffer + 8U, m_options.c_str());
 
-	return write((unsigned char*)buffer, (unsigned int)m_options.length() + 8U);
+	return write(master, (unsigned char*)buffer, (unsigned int)m_options.length() + 8U);
 }
 
-bool CDMRNetwork::writeConfig()
+bool CDMRNetwork::writeConfig(const CDMRMaster& master)
 {
 	const char* software;
 	char slots = '0';
@@ -624,17 +1098,17 @@ bool CDMRNetwork::writeConfig()
 		m_rxFrequency, m_txFrequency, power, m_colorCode, latitude, longitude, height, m_location.c_str(),
 		m_description.c_str(), slots, m_url.c_str(), m_version, software);
 
-	return write((unsigned char*)buffer, 302U);
+	return write(master, (unsigned char*)buffer, 302U);
 }
 
-bool CDMRNetwork::writePing()
+bool CDMRNetwork::writePing(const CDMRMaster& master)
 {
 	unsigned char buffer[11U];
 
 	::memcpy(buffer + 0U, "RPTPING", 7U);
 	::memcpy(buffer + 7U, m_id, 4U);
 
-	return write(buffer, 11U);
+	return write(master, buffer, 11U);
 }
 
 bool CDMRNetwork::wantsBeacon()
@@ -658,9 +1132,23 @@ bool CDMRNetwork::write(const unsigned char* data, unsigned int length)
 	if (!ret) {
 		LogError("DMR, Socket has failed when writing data to the master, retrying connection");
 		m_socket.close();
-		open();
+		m_socketOpen = false;
+		dropStandby();
+		failover();
 		return false;
 	}
 
 	return true;
 }
+
+// Login, probe and standby traffic, which must not tear down the connection in use
+bool CDMRNetwork::write(const CDMRMaster& master, const unsigned char* data, unsigned int length)
+{
+	assert(data != NULL);
+	assert(length > 0U);
+
+	if (&master == &m_masters[m_current])
+		return write(data, length);
+
+	return m_socket.write(data, length, master.m_address, master.m_port);
+}
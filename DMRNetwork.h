@@ -21,13 +21,43 @@
 
 #include "DelayBuffer.h"
 #include "UDPSocket.h"
+#include "StopWatch.h"
 #include "Timer.h"
 #include "DMRData.h"
 #include "Defines.h"
+#include "Mutex.h"
 
 #include <string>
+#include <vector>
 #include <cstdint>
 
+// A master we can log into, and how it answered its last probe
+class CDMRMaster {
+public:
+	CDMRMaster(const std::string& hostName, unsigned int port);
+
+	std::string  m_hostName;
+	unsigned int m_port;
+	in_addr      m_address;
+	bool         m_healthy;
+	unsigned int m_rtt;
+	bool         m_probing;
+	CStopWatch   m_probeWatch;
+};
+
+// The delay buffer of one stream from the master, so that streams which
+// overlap on a slot are paced, and their lost frames repeated, apart
+class CDMRStreamBuffer {
+public:
+	CDMRStreamBuffer(const std::string& name, unsigned int jitter, bool debug);
+
+	CDelayBuffer m_buffer;
+	unsigned int m_slotNo;
+	uint32_t     m_streamId;
+	CTimer       m_idle;		// Frees the buffer of a stream that is never ended
+	bool         m_used;
+};
+
 class CDMRNetwork
 {
 public:
@@ -36,6 +66,14 @@ public:
 
 	void setOptions(const std::string& options);
 
+	// Masters to fail over to, and whether to keep logged into one of them
+	void addMaster(const std::string& address, unsigned int port);
+	void setStandby(bool standby);
+
+	// Applied while running, only a change of master logs in again
+	void setMaster(const std::string& address, unsigned int port, const std::string& password, const std::string& options);
+	void setJitter(unsigned int jitter);
+
 	void setConfig(const std::string& callsign, unsigned int rxFrequency, unsigned int txFrequency, unsigned int power, unsigned int colorCode, float latitude, float longitude, int height, const std::string& location, const std::string& description, const std::string& url);
 
 	bool open();
@@ -54,6 +92,8 @@ public:
 
 	void clock(unsigned int ms);
 
+	// Frees the delay buffer of one stream, or of every stream on a slot
+	void release(unsigned int streamId);
 	void reset(unsigned int slotNo);
 
 	bool isConnected() const;
@@ -61,6 +101,8 @@ public:
 	void close();
 
 private: 
+	std::vector<CDMRMaster> m_masters;
+	unsigned int    m_current;
 	in_addr         m_address;
 	unsigned int    m_port;
 	uint8_t*        m_id;
@@ -72,7 +114,7 @@ private:
 	bool            m_enabled;
 	bool            m_slot1;
 	bool            m_slot2;
-	CDelayBuffer**  m_delayBuffers;
+	std::vector<CDMRStreamBuffer*> m_delayBuffers;
 	HW_TYPE         m_hwType;
 
 	enum STATUS {
@@ -107,13 +149,37 @@ private:
 
 	bool           m_beacon;
 
-	bool writeLogin();
-	bool writeAuthorisation();
-	bool writeOptions();
-	bool writeConfig();
-	bool writePing();
+	CMutex         m_mutex;
+
+	bool           m_socketOpen;
+	unsigned int   m_failures;
+	CTimer         m_probeTimer;
+	bool           m_standbyEnabled;
+	unsigned int   m_standby;
+	STATUS         m_standbyStatus;
+	unsigned char  m_standbySalt[sizeof(uint32_t)];
+	CTimer         m_standbyRetryTimer;
+	CTimer         m_standbyTimeoutTimer;
+
+	bool writeLogin(const CDMRMaster& master);
+	bool writeAuthorisation(const CDMRMaster& master, const unsigned char* salt);
+	bool writeOptions(const CDMRMaster& master);
+	bool writeConfig(const CDMRMaster& master);
+	bool writePing(const CDMRMaster& master);
 
 	bool write(const unsigned char* data, unsigned int length);
+	bool write(const CDMRMaster& master, const unsigned char* data, unsigned int length);
+
+	bool login(STATUS& status, const CDMRMaster& master, unsigned char* salt, const unsigned char* ack);
+	void failover();
+	unsigned int selectMaster(unsigned int exclude) const;
+	int  findMaster(const in_addr& address, unsigned int port) const;
+
+	void clockNetwork(unsigned int ms);
+	void clockProbes(unsigned int ms);
+	void clockStandby(unsigned int ms);
+	void receiveOther(unsigned int index, const unsigned char* data, unsigned int length);
+	void dropStandby();
 
 	void receiveData(const unsigned char* data, unsigned int length);
 };
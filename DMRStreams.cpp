@@ -0,0 +1,189 @@
+/*
+*   Copyright (C) 2018 by Andy Uribe CA6JAU
+*
+*   This program is free software; you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation; either version 2 of the License, or
+*   (at your option) any later version.
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program; if not, write to the Free Software
+*   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+*/
+
+#include "DMRStreams.h"
+#include "Log.h"
+
+#include <cstdio>
+#include <cassert>
+#include <cstring>
+
+CDMRStream::CDMRStream() :
+m_streamId(0U),
+m_slotNo(0U),
+m_srcId(0U),
+m_dstId(0U),
+m_flco(FLCO_GROUP),
+m_netSrc(),
+m_netDst(),
+m_info(false),
+m_located(false),
+m_frames(0U),
+m_lost(0U),
+m_errors(0U),
+m_bits(0U),
+m_leader(0U),
+m_followers(0U),
+m_watchdog(1000U, 0U, 1500U),
+m_used(false)
+{
+	::memset(m_gps, 0x00U, 20U);
+}
+
+CDMRStreams::CDMRStreams(unsigned int size, DMR_ARBITRATION arbitration, unsigned int priorityTG, unsigned int hangTime) :
+m_streams(NULL),
+m_size(size),
+m_arbitration(arbitration),
+m_priorityTG(priorityTG),
+m_active(NULL),
+m_hangDstId(0U),
+m_hangTimer(1000U, hangTime)
+{
+	assert(size > 0U);
+
+	m_streams = new CDMRStream[size];
+}
+
+CDMRStreams::~CDMRStreams()
+{
+	delete[] m_streams;
+}
+
+CDMRStream* CDMRStreams::open(unsigned int streamId, unsigned int slotNo)
+{
+	CDMRStream* stream = find(streamId);
+	if (stream != NULL)
+		return stream;
+
+	for (unsigned int i = 0U; i < m_size; i++) {
+		if (!m_streams[i].m_used) {
+			stream = m_streams + i;
+
+			stream->m_streamId  = streamId;
+			stream->m_slotNo    = slotNo;
+			stream->m_info      = false;
+			stream->m_located   = false;
+			stream->m_frames    = 0U;
+			stream->m_lost      = 0U;
+			stream->m_errors    = 0U;
+			stream->m_bits      = 0U;
+			stream->m_leader    = 0U;
+			stream->m_followers = 0U;
+			stream->m_used      = true;
+			stream->m_watchdog.start();
+
+			return stream;
+		}
+	}
+
+	LogWarning("DMR, no room for stream %08X, ignoring it", streamId);
+
+	return NULL;
+}
+
+CDMRStream* CDMRStreams::find(unsigned int streamId) const
+{
+	for (unsigned int i = 0U; i < m_size; i++) {
+		if (m_streams[i].m_used && m_streams[i].m_streamId == streamId)
+			return m_streams + i;
+	}
+
+	return NULL;
+}
+
+// Returns true if the stream is, or has just become, the one bridged to YSF
+bool CDMRStreams::claim(CDMRStream* stream, CDMRStream*& preempted)
+{
+	assert(stream != NULL);
+
+	preempted = NULL;
+
+	if (m_active == stream)
+		return true;
+
+	if (m_active == NULL) {
+		if (m_arbitration == DA_HANG && m_hangTimer.isRunning() && !m_hangTimer.hasExpired() && stream->m_dstId != m_hangDstId)
+			return false;
+
+		m_hangTimer.stop();
+		m_active = stream;
+		return true;
+	}
+
+	if (m_arbitration == DA_PRIORITY && stream->m_dstId == m_priorityTG && m_active->m_dstId != m_priorityTG) {
+		preempted = m_active;
+		m_active  = stream;
+		return true;
+	}
+
+	return false;
+}
+
+bool CDMRStreams::isActive(const CDMRStream* stream) const
+{
+	return stream != NULL && m_active == stream;
+}
+
+CDMRStream* CDMRStreams::getActive() const
+{
+	return m_active;
+}
+
+void CDMRStreams::close(CDMRStream* stream)
+{
+	assert(stream != NULL);
+
+	if (m_active == stream) {
+		m_active    = NULL;
+		m_hangDstId = stream->m_dstId;
+		m_hangTimer.start();
+	}
+
+	stream->m_watchdog.stop();
+	stream->m_used = false;
+}
+
+bool CDMRStreams::hasSlot(unsigned int slotNo) const
+{
+	for (unsigned int i = 0U; i < m_size; i++) {
+		if (m_streams[i].m_used && m_streams[i].m_slotNo == slotNo)
+			return true;
+	}
+
+	return false;
+}
+
+CDMRStream* CDMRStreams::getExpired() const
+{
+	for (unsigned int i = 0U; i < m_size; i++) {
+		if (m_streams[i].m_used && m_streams[i].m_watchdog.hasExpired())
+			return m_streams + i;
+	}
+
+	return NULL;
+}
+
+void CDMRStreams::clock(unsigned int ms)
+{
+	for (unsigned int i = 0U; i < m_size; i++) {
+		if (m_streams[i].m_used)
+			m_streams[i].m_watchdog.clock(ms);
+	}
+
+	m_hangTimer.clock(ms);
+}
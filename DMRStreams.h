@@ -0,0 +1,91 @@
+/*
+*   Copyright (C) 2018 by Andy Uribe CA6JAU
+*
+*   This program is free software; you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation; either version 2 of the License, or
+*   (at your option) any later version.
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program; if not, write to the Free Software
+*   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+*/
+
+#if !defined(DMRStreams_H)
+#define	DMRStreams_H
+
+#include "DMRDefines.h"
+#include "Timer.h"
+
+#include <string>
+
+// How a stream is chosen when several arrive from the master at once
+enum DMR_ARBITRATION {
+	DA_FIRST,		// The first stream keeps YSF until it ends
+	DA_PRIORITY,	// As above, but a stream to the priority TG takes over
+	DA_HANG			// After a stream ends only its TG may start for the hang time
+};
+
+// The bridge state of one stream received from the DMR network
+class CDMRStream {
+public:
+	CDMRStream();
+
+	unsigned int  m_streamId;
+	unsigned int  m_slotNo;
+	unsigned int  m_srcId;
+	unsigned int  m_dstId;
+	FLCO          m_flco;
+	std::string   m_netSrc;
+	std::string   m_netDst;
+	unsigned char m_gps[20U];
+	bool          m_info;
+	bool          m_located;	// No position is wanted or one has been found
+	unsigned int  m_frames;
+	unsigned int  m_lost;		// Frames the delay buffer had to repeat
+	unsigned int  m_errors;		// Bit errors the master reports, out of m_bits
+	unsigned int  m_bits;
+	unsigned int  m_leader;		// Slot whose transcoder carries this stream, 0 for its own
+	unsigned int  m_followers;	// Bit mask of the slots fed from this stream's transcoder
+	CTimer        m_watchdog;
+	bool          m_used;
+};
+
+// The streams currently being received, keyed by the DMRD stream id, and the
+// one of them that is being bridged to YSF
+class CDMRStreams {
+public:
+	CDMRStreams(unsigned int size, DMR_ARBITRATION arbitration, unsigned int priorityTG, unsigned int hangTime);
+	~CDMRStreams();
+
+	CDMRStream* open(unsigned int streamId, unsigned int slotNo);
+	CDMRStream* find(unsigned int streamId) const;
+
+	bool claim(CDMRStream* stream, CDMRStream*& preempted);
+	bool isActive(const CDMRStream* stream) const;
+	CDMRStream* getActive() const;
+
+	void close(CDMRStream* stream);
+
+	bool hasSlot(unsigned int slotNo) const;
+
+	CDMRStream* getExpired() const;
+
+	void clock(unsigned int ms);
+
+private:
+	CDMRStream*     m_streams;
+	unsigned int    m_size;
+	DMR_ARBITRATION m_arbitration;
+	unsigned int    m_priorityTG;
+	CDMRStream*     m_active;
+	unsigned int    m_hangDstId;
+	CTimer          m_hangTimer;
+};
+
+#endif
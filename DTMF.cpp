@@ -23,6 +23,10 @@
 
 #include "Utils.h"
 
+#include <cstring>
+#include <cstdint>
+#include <cassert>
+
 const unsigned char DTMF_VD2_MASK[] = { 0xCCU, 0xCCU, 0xDDU, 0xDDU, 0xEEU, 0xEEU, 0xFFU, 0xFFU, 0xEEU, 0xEEU, 0xDDU, 0x99U, 0x98U };
 const unsigned char DTMF_VD2_SIG[]  = { 0x08U, 0x80U, 0xC9U, 0x10U, 0x26U, 0xA0U, 0xE3U, 0x31U, 0xE2U, 0xE6U, 0xD5U, 0x08U, 0x88U };
 
@@ -44,6 +48,95 @@ const unsigned char DTMF_VD2_SYMD[] = { 0x11U, 0x10U, 0x20U, 0x20U, 0x11U, 0x01U
 const unsigned char DTMF_VD2_SYMS[] = { 0x00U, 0x23U, 0x02U, 0x02U, 0x11U, 0x10U, 0x10U, 0x01U, 0x22U, 0x62U, 0x04U };
 const unsigned char DTMF_VD2_SYMH[] = { 0x00U, 0x22U, 0x00U, 0x20U, 0x11U, 0x11U, 0x10U, 0x00U, 0x22U, 0x62U, 0x04U };
 
+const char DTMF_VD2_CHARS[] = "0123456789ABCD*#";
+const unsigned char* const DTMF_VD2_SYMS_ALL[] = { DTMF_VD2_SYM0, DTMF_VD2_SYM1, DTMF_VD2_SYM2, DTMF_VD2_SYM3, DTMF_VD2_SYM4, DTMF_VD2_SYM5,
+	DTMF_VD2_SYM6, DTMF_VD2_SYM7, DTMF_VD2_SYM8, DTMF_VD2_SYM9, DTMF_VD2_SYMA, DTMF_VD2_SYMB, DTMF_VD2_SYMC, DTMF_VD2_SYMD, DTMF_VD2_SYMS, DTMF_VD2_SYMH };
+
+// Read in the machine's own byte order, as are the masks and values they are
+// compared with, so that the order never matters
+static uint64_t load64(const unsigned char* p)
+{
+	uint64_t value;
+	::memcpy(&value, p, sizeof(uint64_t));
+	return value;
+}
+
+// The thirteen signature bytes as two overlapping words, 0 to 7 and 5 to 12
+static const uint64_t DTMF_VD2_MASK_LO = load64(DTMF_VD2_MASK);
+static const uint64_t DTMF_VD2_MASK_HI = load64(DTMF_VD2_MASK + 5U);
+static const uint64_t DTMF_VD2_SIG_LO  = load64(DTMF_VD2_SIG);
+static const uint64_t DTMF_VD2_SIG_HI  = load64(DTMF_VD2_SIG + 5U);
+
+// The symbols are read from bytes 0 to 5 and 8 to 12 of the slice, as the
+// same two words with the other bytes masked out
+static void symbolWords(const unsigned char* sym, uint64_t& lo, uint64_t& hi)
+{
+	unsigned char bytes[13U];
+	::memset(bytes, 0x00U, 13U);
+	::memcpy(bytes + 0U, sym + 0U, 6U);
+	::memcpy(bytes + 8U, sym + 6U, 5U);
+
+	lo = load64(bytes);
+	hi = load64(bytes + 5U);
+}
+
+static unsigned int symbolSlot(uint64_t lo, uint64_t hi)
+{
+	uint64_t key = (lo ^ (hi * 0xFF51AFD7ED558CCDULL)) * 0x9E3779B97F4A7C15ULL;
+
+	return (unsigned int)(key >> 59);
+}
+
+// The sixteen symbols in an open addressed table of 32 slots
+class CDTMFSymbols {
+public:
+	CDTMFSymbols()
+	{
+		::memset(m_chars, ' ', 32U);
+
+		symbolWords(DTMF_VD2_SYM_MASK, m_maskLo, m_maskHi);
+
+		for (unsigned int i = 0U; i < 16U; i++) {
+			uint64_t lo, hi;
+			symbolWords(DTMF_VD2_SYMS_ALL[i], lo, hi);
+
+			unsigned int slot = symbolSlot(lo, hi);
+			while (m_chars[slot] != ' ')
+				slot = (slot + 1U) & 0x1FU;
+
+			m_lo[slot]    = lo;
+			m_hi[slot]    = hi;
+			m_chars[slot] = DTMF_VD2_CHARS[i];
+		}
+	}
+
+	// A space for none
+	char find(const unsigned char* ambe) const
+	{
+		uint64_t lo = load64(ambe) & m_maskLo;
+		uint64_t hi = load64(ambe + 5U) & m_maskHi;
+
+		unsigned int slot = symbolSlot(lo, hi);
+		while (m_chars[slot] != ' ') {
+			if (m_lo[slot] == lo && m_hi[slot] == hi)
+				return m_chars[slot];
+
+			slot = (slot + 1U) & 0x1FU;
+		}
+
+		return ' ';
+	}
+
+private:
+	uint64_t m_maskLo;
+	uint64_t m_maskHi;
+	uint64_t m_lo[32U];
+	uint64_t m_hi[32U];
+	char     m_chars[32U];
+};
+
+static const CDTMFSymbols DTMF_VD2_SYMBOLS;
+
 CDTMF::CDTMF() :
 m_data(),
 m_command(),
@@ -76,58 +169,8 @@ WX_STATUS CDTMF::decodeVDMode2(const unsigned char* payload, bool end)
 WX_STATUS CDTMF::decodeVDMode2Slice(const unsigned char* ambe, bool end)
 {
 	// DTMF begins with these byte values
-	if (!end && (ambe[0] & DTMF_VD2_MASK[0]) == DTMF_VD2_SIG[0] && (ambe[1] & DTMF_VD2_MASK[1]) == DTMF_VD2_SIG[1] &&
-		(ambe[2] & DTMF_VD2_MASK[2])   == DTMF_VD2_SIG[2]  && (ambe[3] & DTMF_VD2_MASK[3])   == DTMF_VD2_SIG[3] &&
-		(ambe[4] & DTMF_VD2_MASK[4])   == DTMF_VD2_SIG[4]  && (ambe[5] & DTMF_VD2_MASK[5])   == DTMF_VD2_SIG[5] &&
-		(ambe[6] & DTMF_VD2_MASK[6])   == DTMF_VD2_SIG[6]  && (ambe[7] & DTMF_VD2_MASK[7])   == DTMF_VD2_SIG[7] &&
-		(ambe[8] & DTMF_VD2_MASK[8])   == DTMF_VD2_SIG[8]  && (ambe[9] & DTMF_VD2_MASK[9])   == DTMF_VD2_SIG[9] &&
-		(ambe[10] & DTMF_VD2_MASK[10]) == DTMF_VD2_SIG[10] && (ambe[11] & DTMF_VD2_MASK[11]) == DTMF_VD2_SIG[11] &&
-		(ambe[12] & DTMF_VD2_MASK[12]) == DTMF_VD2_SIG[12]) {
-		unsigned char sym0  = ambe[0]  & DTMF_VD2_SYM_MASK[0];
-		unsigned char sym1  = ambe[1]  & DTMF_VD2_SYM_MASK[1];
-		unsigned char sym2  = ambe[2]  & DTMF_VD2_SYM_MASK[2];
-		unsigned char sym3  = ambe[3]  & DTMF_VD2_SYM_MASK[3];
-		unsigned char sym4  = ambe[4]  & DTMF_VD2_SYM_MASK[4];
-		unsigned char sym5  = ambe[5]  & DTMF_VD2_SYM_MASK[5];
-		unsigned char sym6  = ambe[8]  & DTMF_VD2_SYM_MASK[6];
-		unsigned char sym7  = ambe[9]  & DTMF_VD2_SYM_MASK[7];
-		unsigned char sym8  = ambe[10] & DTMF_VD2_SYM_MASK[8];
-		unsigned char sym9  = ambe[11] & DTMF_VD2_SYM_MASK[9];
-		unsigned char sym10 = ambe[12] & DTMF_VD2_SYM_MASK[10];
-
-		char c = ' ';
-		if (sym0 == DTMF_VD2_SYM0[0] && sym1 == DTMF_VD2_SYM0[1] && sym2 == DTMF_VD2_SYM0[2] && sym3 == DTMF_VD2_SYM0[3] && sym4 == DTMF_VD2_SYM0[4] && sym5 == DTMF_VD2_SYM0[5] && sym6 == DTMF_VD2_SYM0[6] && sym7 == DTMF_VD2_SYM0[7] && sym8 == DTMF_VD2_SYM0[8] && sym9 == DTMF_VD2_SYM0[9] && sym10 == DTMF_VD2_SYM0[10])
-			c = '0';
-		else if (sym0 == DTMF_VD2_SYM1[0] && sym1 == DTMF_VD2_SYM1[1] && sym2 == DTMF_VD2_SYM1[2] && sym3 == DTMF_VD2_SYM1[3] && sym4 == DTMF_VD2_SYM1[4] && sym5 == DTMF_VD2_SYM1[5] && sym6 == DTMF_VD2_SYM1[6] && sym7 == DTMF_VD2_SYM1[7] && sym8 == DTMF_VD2_SYM1[8] && sym9 == DTMF_VD2_SYM1[9] && sym10 == DTMF_VD2_SYM1[10])
-			c = '1';
-		else if (sym0 == DTMF_VD2_SYM2[0] && sym1 == DTMF_VD2_SYM2[1] && sym2 == DTMF_VD2_SYM2[2] && sym3 == DTMF_VD2_SYM2[3] && sym4 == DTMF_VD2_SYM2[4] && sym5 == DTMF_VD2_SYM2[5] && sym6 == DTMF_VD2_SYM2[6] && sym7 == DTMF_VD2_SYM2[7] && sym8 == DTMF_VD2_SYM2[8] && sym9 == DTMF_VD2_SYM2[9] && sym10 == DTMF_VD2_SYM2[10])
-			c = '2';
-		else if (sym0 == DTMF_VD2_SYM3[0] && sym1 == DTMF_VD2_SYM3[1] && sym2 == DTMF_VD2_SYM3[2] && sym3 == DTMF_VD2_SYM3[3] && sym4 == DTMF_VD2_SYM3[4] && sym5 == DTMF_VD2_SYM3[5] && sym6 == DTMF_VD2_SYM3[6] && sym7 == DTMF_VD2_SYM3[7] && sym8 == DTMF_VD2_SYM3[8] && sym9 == DTMF_VD2_SYM3[9] && sym10 == DTMF_VD2_SYM3[10])
-			c = '3';
-		else if (sym0 == DTMF_VD2_SYM4[0] && sym1 == DTMF_VD2_SYM4[1] && sym2 == DTMF_VD2_SYM4[2] && sym3 == DTMF_VD2_SYM4[3] && sym4 == DTMF_VD2_SYM4[4] && sym5 == DTMF_VD2_SYM4[5] && sym6 == DTMF_VD2_SYM4[6] && sym7 == DTMF_VD2_SYM4[7] && sym8 == DTMF_VD2_SYM4[8] && sym9 == DTMF_VD2_SYM4[9] && sym10 == DTMF_VD2_SYM4[10])
-			c = '4';
-		else if (sym0 == DTMF_VD2_SYM5[0] && sym1 == DTMF_VD2_SYM5[1] && sym2 == DTMF_VD2_SYM5[2] && sym3 == DTMF_VD2_SYM5[3] && sym4 == DTMF_VD2_SYM5[4] && sym5 == DTMF_VD2_SYM5[5] && sym6 == DTMF_VD2_SYM5[6] && sym7 == DTMF_VD2_SYM5[7] && sym8 == DTMF_VD2_SYM5[8] && sym9 == DTMF_VD2_SYM5[9] && sym10 == DTMF_VD2_SYM5[10])
-			c = '5';
-		else if (sym0 == DTMF_VD2_SYM6[0] && sym1 == DTMF_VD2_SYM6[1] && sym2 == DTMF_VD2_SYM6[2] && sym3 == DTMF_VD2_SYM6[3] && sym4 == DTMF_VD2_SYM6[4] && sym5 == DTMF_VD2_SYM6[5] && sym6 == DTMF_VD2_SYM6[6] && sym7 == DTMF_VD2_SYM6[7] && sym8 == DTMF_VD2_SYM6[8] && sym9 == DTMF_VD2_SYM6[9] && sym10 == DTMF_VD2_SYM6[10])
-			c = '6';
-		else if (sym0 == DTMF_VD2_SYM7[0] && sym1 == DTMF_VD2_SYM7[1] && sym2 == DTMF_VD2_SYM7[2] && sym3 == DTMF_VD2_SYM7[3] && sym4 == DTMF_VD2_SYM7[4] && sym5 == DTMF_VD2_SYM7[5] && sym6 == DTMF_VD2_SYM7[6] && sym7 == DTMF_VD2_SYM7[7] && sym8 == DTMF_VD2_SYM7[8] && sym9 == DTMF_VD2_SYM7[9] && sym10 == DTMF_VD2_SYM7[10])
-			c = '7';
-		else if (sym0 == DTMF_VD2_SYM8[0] && sym1 == DTMF_VD2_SYM8[1] && sym2 == DTMF_VD2_SYM8[2] && sym3 == DTMF_VD2_SYM8[3] && sym4 == DTMF_VD2_SYM8[4] && sym5 == DTMF_VD2_SYM8[5] && sym6 == DTMF_VD2_SYM8[6] && sym7 == DTMF_VD2_SYM8[7] && sym8 == DTMF_VD2_SYM8[8] && sym9 == DTMF_VD2_SYM8[9] && sym10 == DTMF_VD2_SYM8[10])
-			c = '8';
-		else if (sym0 == DTMF_VD2_SYM9[0] && sym1 == DTMF_VD2_SYM9[1] && sym2 == DTMF_VD2_SYM9[2] && sym3 == DTMF_VD2_SYM9[3] && sym4 == DTMF_VD2_SYM9[4] && sym5 == DTMF_VD2_SYM9[5] && sym6 == DTMF_VD2_SYM9[6] && sym7 == DTMF_VD2_SYM9[7] && sym8 == DTMF_VD2_SYM9[8] && sym9 == DTMF_VD2_SYM9[9] && sym10 == DTMF_VD2_SYM9[10])
-			c = '9';
-		else if (sym0 == DTMF_VD2_SYMA[0] && sym1 == DTMF_VD2_SYMA[1] && sym2 == DTMF_VD2_SYMA[2] && sym3 == DTMF_VD2_SYMA[3] && sym4 == DTMF_VD2_SYMA[4] && sym5 == DTMF_VD2_SYMA[5] && sym6 == DTMF_VD2_SYMA[6] && sym7 == DTMF_VD2_SYMA[7] && sym8 == DTMF_VD2_SYMA[8] && sym9 == DTMF_VD2_SYMA[9] && sym10 == DTMF_VD2_SYMA[10])
-			c = 'A';
-		else if (sym0 == DTMF_VD2_SYMB[0] && sym1 == DTMF_VD2_SYMB[1] && sym2 == DTMF_VD2_SYMB[2] && sym3 == DTMF_VD2_SYMB[3] && sym4 == DTMF_VD2_SYMB[4] && sym5 == DTMF_VD2_SYMB[5] && sym6 == DTMF_VD2_SYMB[6] && sym7 == DTMF_VD2_SYMB[7] && sym8 == DTMF_VD2_SYMB[8] && sym9 == DTMF_VD2_SYMB[9] && sym10 == DTMF_VD2_SYMB[10])
-			c = 'B';
-		else if (sym0 == DTMF_VD2_SYMC[0] && sym1 == DTMF_VD2_SYMC[1] && sym2 == DTMF_VD2_SYMC[2] && sym3 == DTMF_VD2_SYMC[3] && sym4 == DTMF_VD2_SYMC[4] && sym5 == DTMF_VD2_SYMC[5] && sym6 == DTMF_VD2_SYMC[6] && sym7 == DTMF_VD2_SYMC[7] && sym8 == DTMF_VD2_SYMC[8] && sym9 == DTMF_VD2_SYMC[9] && sym10 == DTMF_VD2_SYMC[10])
-			c = 'C';
-		else if (sym0 == DTMF_VD2_SYMD[0] && sym1 == DTMF_VD2_SYMD[1] && sym2 == DTMF_VD2_SYMD[2] && sym3 == DTMF_VD2_SYMD[3] && sym4 == DTMF_VD2_SYMD[4] && sym5 == DTMF_VD2_SYMD[5] && sym6 == DTMF_VD2_SYMD[6] && sym7 == DTMF_VD2_SYMD[7] && sym8 == DTMF_VD2_SYMD[8] && sym9 == DTMF_VD2_SYMD[9] && sym10 == DTMF_VD2_SYMD[10])
-			c = 'D';
-		else if (sym0 == DTMF_VD2_SYMS[0] && sym1 == DTMF_VD2_SYMS[1] && sym2 == DTMF_VD2_SYMS[2] && sym3 == DTMF_VD2_SYMS[3] && sym4 == DTMF_VD2_SYMS[4] && sym5 == DTMF_VD2_SYMS[5] && sym6 == DTMF_VD2_SYMS[6] && sym7 == DTMF_VD2_SYMS[7] && sym8 == DTMF_VD2_SYMS[8] && sym9 == DTMF_VD2_SYMS[9] && sym10 == DTMF_VD2_SYMS[10])
-			c = '*';
-		else if (sym0 == DTMF_VD2_SYMH[0] && sym1 == DTMF_VD2_SYMH[1] && sym2 == DTMF_VD2_SYMH[2] && sym3 == DTMF_VD2_SYMH[3] && sym4 == DTMF_VD2_SYMH[4] && sym5 == DTMF_VD2_SYMH[5] && sym6 == DTMF_VD2_SYMH[6] && sym7 == DTMF_VD2_SYMH[7] && sym8 == DTMF_VD2_SYMH[8] && sym9 == DTMF_VD2_SYMH[9] && sym10 == DTMF_VD2_SYMH[10])
-			c = '#';
+	if (!end && (load64(ambe) & DTMF_VD2_MASK_LO) == DTMF_VD2_SIG_LO && (load64(ambe + 5U) & DTMF_VD2_MASK_HI) == DTMF_VD2_SIG_HI) {
+		char c = DTMF_VD2_SYMBOLS.find(ambe);
 
 		if (c == m_lastChar) {
 			m_pressCount++;
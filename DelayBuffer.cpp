@@ -45,6 +45,9 @@ m_lastDataValid(false)
 
 	m_lastData = new unsigned char[m_blockSize];
 
+	// Keep the most recent blocks so the delay stays bounded
+	m_buffer.setOverflow(RBO_DROP_OLDEST, m_blockSize);
+
 	reset();
 }
 
@@ -147,6 +150,13 @@ void CDelayBuffer::reset()
 	m_running = false;
 }
 
+void CDelayBuffer::setJitter(unsigned int jitterTime)
+{
+	assert(jitterTime > 0U);
+
+	m_timer.setTimeout(0U, jitterTime);
+}
+
 void CDelayBuffer::clock(unsigned int ms)
 {
 	m_timer.clock(ms);
@@ -37,6 +37,9 @@ public:
 
 	void reset();
 
+	// The delay before the next stream starts to play out
+	void setJitter(unsigned int jitterTime);
+
 	void clock(unsigned int ms);
 
 private:
@@ -0,0 +1,351 @@
+/*
+*   Copyright (C) 2018 by Andy Uribe CA6JAU
+*
+*   This program is free software; you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation; either version 2 of the License, or
+*   (at your option) any later version.
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program; if not, write to the Free Software
+*   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+*/
+
+#include "FileWatcher.h"
+#include "StopWatch.h"
+#include "Log.h"
+
+#include <cstdio>
+#include <cstring>
+#include <cassert>
+
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#if defined(__linux__)
+#include <sys/inotify.h>
+#include <poll.h>
+#include <unistd.h>
+#endif
+
+// How long a file has to be left alone after a write before it is read
+const unsigned int SETTLE_TIME = 500U;
+
+// How often the size and time of every file are looked at, in ms
+const unsigned int POLL_TIME = 5000U;
+
+const unsigned int TICK_TIME = 250U;
+
+CWatchedFile::CWatchedFile(const std::string& fileName, CFileListener* listener, bool load, bool once) :
+m_fileName(fileName),
+m_name(fileName),
+m_listener(listener),
+m_watch(-1),
+m_known(false),
+m_size(0),
+m_time(0),
+m_timeNs(0L),
+m_changed(false),
+m_settle(0U),
+m_load(load),
+m_once(once)
+{
+	std::string::size_type pos = fileName.find_last_of('/');
+	if (pos != std::string::npos)
+		m_name = fileName.substr(pos + 1U);
+
+	::memset(m_hash, 0x00U, SHA256_DIGEST_SIZE);
+}
+
+CFileWatcher::CFileWatcher() :
+CThread(),
+m_fd(-1),
+m_files(),
+m_mutex(),
+m_stop(false),
+m_pollTimer(0U)
+{
+}
+
+CFileWatcher::~CFileWatcher()
+{
+}
+
+bool CFileWatcher::start()
+{
+#if defined(__linux__)
+	m_fd = ::inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+	if (m_fd < 0)
+		LogWarning("Cannot use inotify, files are only checked every %us", POLL_TIME / 1000U);
+#endif
+
+	setName("file-watcher");
+
+	return run();
+}
+
+void CFileWatcher::add(const std::string& fileName, CFileListener* listener, bool load)
+{
+	assert(!fileName.empty());
+	assert(listener != NULL);
+
+	CWatchedFile file(fileName, listener, load, false);
+
+#if defined(__linux__)
+	if (m_fd >= 0) {
+		std::string dir = ".";
+		std::string::size_type pos = fileName.find_last_of('/');
+		if (pos != std::string::npos)
+			dir = pos == 0U ? "/" : fileName.substr(0U, pos);
+
+		// The same directory gives back the same watch
+		file.m_watch = ::inotify_add_watch(m_fd, dir.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+		if (file.m_watch < 0)
+			LogWarning("Cannot watch %s, it is only checked every %us", dir.c_str(), POLL_TIME / 1000U);
+	}
+#endif
+
+	m_mutex.lock();
+	m_files.push_back(file);
+	m_mutex.unlock();
+}
+
+void CFileWatcher::load(const std::string& fileName, CFileListener* listener)
+{
+	assert(!fileName.empty());
+	assert(listener != NULL);
+
+	m_mutex.lock();
+	m_files.push_back(CWatchedFile(fileName, listener, true, true));
+	m_mutex.unlock();
+}
+
+// A callback already under way for the listener may still finish afterwards
+void CFileWatcher::remove(CFileListener* listener)
+{
+	assert(listener != NULL);
+
+	m_mutex.lock();
+
+	for (std::vector<CWatchedFile>::iterator it = m_files.begin(); it != m_files.end();) {
+		if (it->m_listener != listener) {
+			++it;
+			continue;
+		}
+
+#if defined(__linux__)
+		int watch = it->m_watch;
+
+		it = m_files.erase(it);
+
+		bool used = false;
+		for (std::vector<CWatchedFile>::const_iterator jt = m_files.begin(); jt != m_files.end(); ++jt) {
+			if (jt->m_watch == watch)
+				used = true;
+		}
+
+		if (watch >= 0 && !used)
+			::inotify_rm_watch(m_fd, watch);
+#else
+		it = m_files.erase(it);
+#endif
+	}
+
+	m_mutex.unlock();
+}
+
+void CFileWatcher::entry()
+{
+	LogInfo("Started the file watcher thread");
+
+	CStopWatch stopWatch;
+	stopWatch.start();
+
+	while (!m_stop) {
+#if defined(__linux__)
+		if (m_fd >= 0) {
+			struct pollfd pfd;
+			pfd.fd      = m_fd;
+			pfd.events  = POLLIN;
+			pfd.revents = 0;
+
+			if (::poll(&pfd, 1, TICK_TIME) > 0)
+				readEvents();
+		} else {
+			sleep(TICK_TIME);
+		}
+#else
+		sleep(TICK_TIME);
+#endif
+
+		unsigned int ms = stopWatch.elapsed();
+		stopWatch.start();
+
+		clockFiles(ms);
+	}
+
+#if defined(__linux__)
+	if (m_fd >= 0) {
+		::close(m_fd);
+		m_fd = -1;
+	}
+#endif
+
+	LogInfo("Stopped the file watcher thread");
+}
+
+void CFileWatcher::stop()
+{
+	m_stop = true;
+
+	wait();
+}
+
+void CFileWatcher::readEvents()
+{
+#if defined(__linux__)
+	// Aligned as the kernel writes struct inotify_event into it
+	char buffer[4096U] __attribute__ ((aligned(__alignof__(struct inotify_event))));
+
+	for (;;) {
+		ssize_t len = ::read(m_fd, buffer, sizeof(buffer));
+		if (len <= 0)
+			return;
+
+		m_mutex.lock();
+
+		for (char* p = buffer; p < buffer + len;) {
+			const struct inotify_event* event = (const struct inotify_event*)p;
+
+			if (event->len > 0U) {
+				for (std::vector<CWatchedFile>::iterator it = m_files.begin(); it != m_files.end(); ++it) {
+					if (it->m_watch == event->wd && it->m_name == event->name) {
+						it->m_changed = true;
+						it->m_settle  = SETTLE_TIME;
+					}
+				}
+			}
+
+			p += sizeof(struct inotify_event) + event->len;
+		}
+
+		m_mutex.unlock();
+	}
+#endif
+}
+
+// The files are read and hashed, and the listeners called, without holding
+// the lock, so that adding or removing a file never waits on a long load
+void CFileWatcher::clockFiles(unsigned int ms)
+{
+	m_pollTimer += ms;
+	bool poll = m_pollTimer >= POLL_TIME;
+	if (poll)
+		m_pollTimer = 0U;
+
+	std::vector<CWatchedFile> due;
+
+	m_mutex.lock();
+
+	for (std::vector<CWatchedFile>::iterator it = m_files.begin(); it != m_files.end(); ++it) {
+		bool settled = false;
+		if (it->m_changed) {
+			it->m_settle = it->m_settle > ms ? it->m_settle - ms : 0U;
+			settled = it->m_settle == 0U;
+		}
+
+		if (settled || poll || it->m_load || !it->m_known) {
+			due.push_back(*it);
+			due.back().m_changed = settled;
+			it->m_changed = !settled && it->m_changed;
+			it->m_load    = false;
+		}
+	}
+
+	m_mutex.unlock();
+
+	for (std::vector<CWatchedFile>::iterator it = due.begin(); it != due.end(); ++it) {
+		CWatchedFile file = *it;
+
+		// A new size or time is only a hint, the contents decide
+		bool hash = !it->m_known || it->m_changed || it->m_load;
+		bool exists = readFile(it->m_fileName, file, hash);
+
+		if (exists && !hash && (file.m_size != it->m_size || file.m_time != it->m_time || file.m_timeNs != it->m_timeNs))
+			exists = readFile(it->m_fileName, file, true);
+
+		// Nothing is known of a file before its first look, unless it was written to
+		bool changed = exists && (it->m_known ? ::memcmp(file.m_hash, it->m_hash, SHA256_DIGEST_SIZE) != 0 : it->m_changed);
+
+		m_mutex.lock();
+
+		for (std::vector<CWatchedFile>::iterator jt = m_files.begin(); jt != m_files.end(); ++jt) {
+			if (jt->m_listener == it->m_listener && jt->m_fileName == it->m_fileName) {
+				jt->m_known  = true;
+				jt->m_size   = file.m_size;
+				jt->m_time   = file.m_time;
+				jt->m_timeNs = file.m_timeNs;
+				::memcpy(jt->m_hash, file.m_hash, SHA256_DIGEST_SIZE);
+
+				if (jt->m_once && it->m_load) {
+					m_files.erase(jt);
+					break;
+				}
+			}
+		}
+
+		m_mutex.unlock();
+
+		if (changed)
+			LogMessage("%s has changed, loading it again", it->m_fileName.c_str());
+
+		if (changed || it->m_load)
+			it->m_listener->fileChanged(it->m_fileName);
+	}
+}
+
+// The hash is only worked out when asked for, so that the polling of files
+// that have not changed costs no more than a stat. A missing file is given
+// a size of -1 and an empty hash.
+bool CFileWatcher::readFile(const std::string& fileName, CWatchedFile& file, bool hash) const
+{
+	struct stat st;
+	if (::stat(fileName.c_str(), &st) != 0) {
+		file.m_size   = -1;
+		file.m_time   = 0;
+		file.m_timeNs = 0L;
+		::memset(file.m_hash, 0x00U, SHA256_DIGEST_SIZE);
+		return false;
+	}
+
+	file.m_size = (long long)st.st_size;
+	file.m_time = st.st_mtime;
+#if defined(__linux__)
+	file.m_timeNs = st.st_mtim.tv_nsec;
+#endif
+
+	if (!hash)
+		return true;
+
+	FILE* fp = ::fopen(fileName.c_str(), "rb");
+	if (fp == NULL)
+		return false;
+
+	CSHA256 sha256;
+
+	unsigned char buffer[16384U];
+	size_t len;
+	while ((len = ::fread(buffer, 1U, sizeof(buffer), fp)) > 0U)
+		sha256.processBytes(buffer, (unsigned int)len);
+
+	::fclose(fp);
+
+	sha256.finish(file.m_hash);
+
+	return true;
+}
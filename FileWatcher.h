@@ -0,0 +1,92 @@
+/*
+*   Copyright (C) 2018 by Andy Uribe CA6JAU
+*
+*   This program is free software; you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation; either version 2 of the License, or
+*   (at your option) any later version.
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program; if not, write to the Free Software
+*   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+*/
+
+#if !defined(FileWatcher_H)
+#define	FileWatcher_H
+
+#include "SHA256.h"
+#include "Thread.h"
+#include "Mutex.h"
+
+#include <string>
+#include <vector>
+#include <atomic>
+#include <ctime>
+
+// Told of a file with new contents, on the watcher's thread, so that a long
+// load never holds up a voice thread
+class CFileListener {
+public:
+	virtual ~CFileListener() {}
+
+	virtual void fileChanged(const std::string& fileName) = 0;
+};
+
+class CWatchedFile {
+public:
+	CWatchedFile(const std::string& fileName, CFileListener* listener, bool load, bool once);
+
+	std::string    m_fileName;
+	std::string    m_name;		// Without the directory, as inotify reports it
+	CFileListener* m_listener;
+	int            m_watch;		// The inotify watch on its directory, -1 for none
+	bool           m_known;		// Whether the size, time and hash below have been read
+	long long      m_size;
+	time_t         m_time;
+	long           m_timeNs;
+	unsigned char  m_hash[SHA256_DIGEST_SIZE];
+	bool           m_changed;	// Written to, waiting for the writes to settle
+	unsigned int   m_settle;
+	bool           m_load;		// Passed to the listener whether it has changed or not
+	bool           m_once;		// Dropped once passed to the listener
+};
+
+// Files are watched through inotify on their directories, which sees a file
+// that is replaced by a rename as well as one written in place, and their
+// size and time are also polled for the file systems inotify misses. Only a
+// change to the contents, found by hashing the file, reaches the listener.
+class CFileWatcher : public CThread {
+public:
+	CFileWatcher();
+	virtual ~CFileWatcher();
+
+	bool start();
+
+	void add(const std::string& fileName, CFileListener* listener, bool load = false);
+	void remove(CFileListener* listener);
+
+	// Passed to the listener once, without being watched
+	void load(const std::string& fileName, CFileListener* listener);
+
+	virtual void entry();
+
+	void stop();
+
+private:
+	int                       m_fd;
+	std::vector<CWatchedFile> m_files;
+	CMutex                    m_mutex;
+	std::atomic<bool>         m_stop;
+	unsigned int              m_pollTimer;
+
+	void readEvents();
+	void clockFiles(unsigned int ms);
+	bool readFile(const std::string& fileName, CWatchedFile& file, bool hash) const;
+};
+
+#endif
@@ -0,0 +1,67 @@
+/*
+*   Copyright (C) 2018 by Andy Uribe CA6JAU
+*
+*   This program is free software; you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation; either version 2 of the License, or
+*   (at your option) any later version.
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program; if not, write to the Free Software
+*   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+*/
+
+#include "FramePacer.h"
+
+#include <cstdio>
+#include <cassert>
+
+CFramePacer::CFramePacer(unsigned int period, unsigned int target) :
+m_period(period),
+m_target(target),
+m_current(period),
+m_carry(0U),
+m_stopWatch()
+{
+	assert(period > 0U);
+
+	m_stopWatch.start();
+}
+
+CFramePacer::~CFramePacer()
+{
+}
+
+// Depth is the number of whole frames waiting to be sent
+bool CFramePacer::isDue(unsigned int depth)
+{
+	int limit  = int(m_period / 8U);
+	int adjust = (int(depth) - int(m_target)) * int(m_period) / 16;
+
+	if (adjust > limit)
+		adjust = limit;
+	else if (adjust < -limit)
+		adjust = -limit;
+
+	m_current = m_period - adjust;
+
+	return m_stopWatch.elapsed() + m_carry >= m_current;
+}
+
+void CFramePacer::sent()
+{
+	unsigned int elapsed = m_stopWatch.elapsed() + m_carry;
+	m_stopWatch.start();
+
+	// Carry over how late this frame was, so the loop granularity does not
+	// stretch the period, but start afresh after a gap in the stream
+	if (elapsed >= m_current && elapsed - m_current < m_current / 2U)
+		m_carry = elapsed - m_current;
+	else
+		m_carry = 0U;
+}
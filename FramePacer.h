@@ -0,0 +1,46 @@
+/*
+*   Copyright (C) 2018 by Andy Uribe CA6JAU
+*
+*   This program is free software; you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation; either version 2 of the License, or
+*   (at your option) any later version.
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program; if not, write to the Free Software
+*   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+*/
+
+#if !defined(FramePacer_H)
+#define	FramePacer_H
+
+#include "StopWatch.h"
+
+// Paces an egress stream at its nominal frame period, trimmed by up to an
+// eighth either way so that the number of frames waiting to be sent is held
+// at a target. This absorbs the drift between the clock of the network that
+// feeds the frames in and the local clock that sends them out, so the delay
+// through the bridge stays constant however long a stream lasts.
+class CFramePacer {
+public:
+	CFramePacer(unsigned int period, unsigned int target);
+	~CFramePacer();
+
+	bool isDue(unsigned int depth);
+
+	void sent();
+
+private:
+	unsigned int m_period;
+	unsigned int m_target;
+	unsigned int m_current;
+	unsigned int m_carry;
+	CStopWatch   m_stopWatch;
+};
+
+#endif
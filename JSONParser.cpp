@@ -0,0 +1,361 @@
+/*
+*   Copyright (C) 2018 by Andy Uribe CA6JAU
+*
+*   This program is free software; you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation; either version 2 of the License, or
+*   (at your option) any later version.
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program; if not, write to the Free Software
+*   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+*/
+
+#include "JSONParser.h"
+
+#include <cstdio>
+#include <cassert>
+#include <cstring>
+
+// No single string or number in a reply we read comes anywhere near this
+const unsigned int JSON_MAX_TOKEN = 4096U;
+
+const unsigned int JSON_MAX_DEPTH = 64U;
+
+CJSONParser::CJSONParser() :
+m_state(JS_VALUE),
+m_token(JT_NONE),
+m_text(),
+m_key(false),
+m_escape(false),
+m_hexDigits(0U),
+m_codePoint(0U),
+m_stack()
+{
+}
+
+CJSONParser::~CJSONParser()
+{
+}
+
+void CJSONParser::reset()
+{
+	m_state     = JS_VALUE;
+	m_token     = JT_NONE;
+	m_key       = false;
+	m_escape    = false;
+	m_hexDigits = 0U;
+	m_codePoint = 0U;
+
+	m_text.clear();
+	m_stack.clear();
+}
+
+bool CJSONParser::feed(const unsigned char* data, unsigned int length)
+{
+	assert(data != NULL);
+
+	for (unsigned int i = 0U; i < length && m_state != JS_ERROR; i++) {
+		if (!character(data[i]))
+			m_state = JS_ERROR;
+	}
+
+	return m_state != JS_ERROR;
+}
+
+bool CJSONParser::isComplete() const
+{
+	return m_state == JS_DONE;
+}
+
+bool CJSONParser::hasError() const
+{
+	return m_state == JS_ERROR;
+}
+
+unsigned int CJSONParser::getDepth() const
+{
+	return (unsigned int)m_stack.size();
+}
+
+void CJSONParser::onStartObject()
+{
+}
+
+void CJSONParser::onEndObject()
+{
+}
+
+void CJSONParser::onStartArray()
+{
+}
+
+void CJSONParser::onEndArray()
+{
+}
+
+void CJSONParser::onKey(const std::string&)
+{
+}
+
+void CJSONParser::onValue(JSON_TYPE, const std::string&)
+{
+}
+
+bool CJSONParser::character(unsigned char c)
+{
+	if (m_token == JT_STRING)
+		return string(c);
+
+	// Numbers and literals have no closing character, the first one that
+	// cannot belong to them ends them and is then handled as usual
+	if (m_token == JT_NUMBER) {
+		if ((c >= '0' && c <= '9') || c == '-' || c == '+' || c == '.' || c == 'e' || c == 'E') {
+			m_text += char(c);
+			return m_text.length() <= JSON_MAX_TOKEN;
+		}
+
+		if (!endToken())
+			return false;
+	} else if (m_token == JT_LITERAL) {
+		if (c >= 'a' && c <= 'z') {
+			m_text += char(c);
+			return m_text.length() <= 5U;
+		}
+
+		if (!endToken())
+			return false;
+	}
+
+	if (c == ' ' || c == '\t' || c == '\r' || c == '\n')
+		return true;
+
+	switch (m_state) {
+		case JS_VALUE:
+		case JS_VALUE_OR_END:
+			if (c == '{' || c == '[') {
+				if (m_stack.size() >= JSON_MAX_DEPTH)
+					return false;
+
+				m_stack.push_back(char(c));
+
+				if (c == '{') {
+					onStartObject();
+					m_state = JS_KEY_OR_END;
+				} else {
+					onStartArray();
+					m_state = JS_VALUE_OR_END;
+				}
+				return true;
+			}
+
+			if (c == ']' && m_state == JS_VALUE_OR_END)
+				return endContainer('[');
+
+			m_text.clear();
+			m_key = false;
+
+			if (c == '"') {
+				m_token = JT_STRING;
+			} else if (c == '-' || (c >= '0' && c <= '9')) {
+				m_text += char(c);
+				m_token = JT_NUMBER;
+			} else if (c == 't' || c == 'f' || c == 'n') {
+				m_text += char(c);
+				m_token = JT_LITERAL;
+			} else {
+				return false;
+			}
+			return true;
+
+		case JS_KEY:
+		case JS_KEY_OR_END:
+			if (c == '}' && m_state == JS_KEY_OR_END)
+				return endContainer('{');
+
+			if (c != '"')
+				return false;
+
+			m_text.clear();
+			m_key   = true;
+			m_token = JT_STRING;
+			return true;
+
+		case JS_COLON:
+			if (c != ':')
+				return false;
+
+			m_state = JS_VALUE;
+			return true;
+
+		case JS_COMMA_OR_END:
+			if (c == ',') {
+				m_state = m_stack.back() == '{' ? JS_KEY : JS_VALUE;
+				return true;
+			}
+
+			if (c == '}')
+				return endContainer('{');
+			if (c == ']')
+				return endContainer('[');
+
+			return false;
+
+		default:
+			return false;
+	}
+}
+
+bool CJSONParser::string(unsigned char c)
+{
+	if (m_hexDigits > 0U) {
+		unsigned int digit;
+		if (c >= '0' && c <= '9')
+			digit = c - '0';
+		else if (c >= 'a' && c <= 'f')
+			digit = c - 'a' + 10U;
+		else if (c >= 'A' && c <= 'F')
+			digit = c - 'A' + 10U;
+		else
+			return false;
+
+		m_codePoint = (m_codePoint << 4) | digit;
+
+		if (--m_hexDigits == 0U)
+			appendUTF8(m_codePoint);
+
+		return true;
+	}
+
+	if (m_escape) {
+		m_escape = false;
+
+		switch (c) {
+			case '"':
+			case '\\':
+			case '/':
+				m_text += char(c);
+				break;
+			case 'b':
+				m_text += '\b';
+				break;
+			case 'f':
+				m_text += '\f';
+				break;
+			case 'n':
+				m_text += '\n';
+				break;
+			case 'r':
+				m_text += '\r';
+				break;
+			case 't':
+				m_text += '\t';
+				break;
+			case 'u':
+				m_hexDigits = 4U;
+				m_codePoint = 0U;
+				break;
+			default:
+				return false;
+		}
+
+		return true;
+	}
+
+	if (c == '\\') {
+		m_escape = true;
+		return true;
+	}
+
+	if (c == '"')
+		return endToken();
+
+	if (c < 0x20U)
+		return false;
+
+	m_text += char(c);
+
+	return m_text.length() <= JSON_MAX_TOKEN;
+}
+
+bool CJSONParser::endToken()
+{
+	JSON_TOKEN token = m_token;
+	m_token = JT_NONE;
+
+	switch (token) {
+		case JT_STRING:
+			if (m_key) {
+				onKey(m_text);
+				m_state = JS_COLON;
+				return true;
+			}
+
+			onValue(JSON_STRING, m_text);
+			break;
+
+		case JT_NUMBER:
+			onValue(JSON_NUMBER, m_text);
+			break;
+
+		case JT_LITERAL:
+			if (m_text == "true")
+				onValue(JSON_TRUE, m_text);
+			else if (m_text == "false")
+				onValue(JSON_FALSE, m_text);
+			else if (m_text == "null")
+				onValue(JSON_NULL, m_text);
+			else
+				return false;
+			break;
+
+		default:
+			return false;
+	}
+
+	endValue();
+
+	return true;
+}
+
+bool CJSONParser::endContainer(char type)
+{
+	if (m_stack.empty() || m_stack.back() != type)
+		return false;
+
+	if (type == '{')
+		onEndObject();
+	else
+		onEndArray();
+
+	m_stack.pop_back();
+
+	endValue();
+
+	return true;
+}
+
+void CJSONParser::endValue()
+{
+	m_state = m_stack.empty() ? JS_DONE : JS_COMMA_OR_END;
+}
+
+// Surrogate pairs are not joined, each half is encoded on its own
+void CJSONParser::appendUTF8(unsigned int codePoint)
+{
+	if (codePoint < 0x80U) {
+		m_text += char(codePoint);
+	} else if (codePoint < 0x800U) {
+		m_text += char(0xC0U | (codePoint >> 6));
+		m_text += char(0x80U | (codePoint & 0x3FU));
+	} else {
+		m_text += char(0xE0U | (codePoint >> 12));
+		m_text += char(0x80U | ((codePoint >> 6) & 0x3FU));
+		m_text += char(0x80U | (codePoint & 0x3FU));
+	}
+}
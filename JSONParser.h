@@ -0,0 +1,95 @@
+/*
+*   Copyright (C) 2018 by Andy Uribe CA6JAU
+*
+*   This program is free software; you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation; either version 2 of the License, or
+*   (at your option) any later version.
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program; if not, write to the Free Software
+*   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+*/
+
+#if !defined(JSONParser_H)
+#define	JSONParser_H
+
+#include <string>
+#include <vector>
+
+enum JSON_TYPE {
+	JSON_STRING,
+	JSON_NUMBER,
+	JSON_TRUE,
+	JSON_FALSE,
+	JSON_NULL
+};
+
+// A streaming JSON parser, the text may be fed in pieces of any size as it
+// arrives. It keeps no document, a subclass picks out what it wants as the
+// events go past. Inside a callback getDepth() is the depth of the container
+// being started, ended or holding the key or value.
+class CJSONParser {
+public:
+	CJSONParser();
+	virtual ~CJSONParser();
+
+	void reset();
+
+	bool feed(const unsigned char* data, unsigned int length);
+
+	bool isComplete() const;
+	bool hasError() const;
+
+protected:
+	virtual void onStartObject();
+	virtual void onEndObject();
+	virtual void onStartArray();
+	virtual void onEndArray();
+	virtual void onKey(const std::string& key);
+	virtual void onValue(JSON_TYPE type, const std::string& value);
+
+	unsigned int getDepth() const;
+
+private:
+	enum JSON_STATE {
+		JS_VALUE,
+		JS_VALUE_OR_END,
+		JS_KEY,
+		JS_KEY_OR_END,
+		JS_COLON,
+		JS_COMMA_OR_END,
+		JS_DONE,
+		JS_ERROR
+	};
+
+	enum JSON_TOKEN {
+		JT_NONE,
+		JT_STRING,
+		JT_NUMBER,
+		JT_LITERAL
+	};
+
+	JSON_STATE        m_state;
+	JSON_TOKEN        m_token;
+	std::string       m_text;
+	bool              m_key;
+	bool              m_escape;
+	unsigned int      m_hexDigits;
+	unsigned int      m_codePoint;
+	std::vector<char> m_stack;
+
+	bool character(unsigned char c);
+	bool string(unsigned char c);
+	bool endToken();
+	bool endContainer(char type);
+	void endValue();
+	void appendUTF8(unsigned int codePoint);
+};
+
+#endif
@@ -0,0 +1,167 @@
+/*
+*   Copyright (C) 2018 by Andy Uribe CA6JAU
+*
+*   This program is free software; you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation; either version 2 of the License, or
+*   (at your option) any later version.
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program; if not, write to the Free Software
+*   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+*/
+
+#include "LastHeard.h"
+#include "Log.h"
+
+#include <cstdio>
+#include <cstring>
+#include <cassert>
+#include <ctime>
+
+#if !defined(_WIN32) && !defined(_WIN64)
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+CLastHeard::CLastHeard(const std::string& name) :
+m_name(name),
+m_fd(-1),
+m_memory(NULL),
+m_mutex()
+{
+	assert(!name.empty());
+}
+
+CLastHeard::~CLastHeard()
+{
+}
+
+#if defined(_WIN32) || defined(_WIN64)
+bool CLastHeard::open()
+{
+	LogError("The last heard shared memory is not supported on Windows");
+	return false;
+}
+
+void CLastHeard::write(CLastHeardEvent&)
+{
+}
+
+void CLastHeard::close()
+{
+}
+#else
+bool CLastHeard::open()
+{
+	m_fd = ::shm_open(m_name.c_str(), O_RDWR | O_CREAT, 0644);
+	if (m_fd < 0) {
+		LogError("Cannot open the last heard shared memory %s", m_name.c_str());
+		return false;
+	}
+
+	// Left readable to others, a dashboard will often run as another user
+	::fchmod(m_fd, 0644);
+
+	if (::ftruncate(m_fd, sizeof(CLastHeardMemory)) < 0) {
+		LogError("Cannot size the last heard shared memory %s", m_name.c_str());
+		::close(m_fd);
+		m_fd = -1;
+		return false;
+	}
+
+	void* p = ::mmap(NULL, sizeof(CLastHeardMemory), PROT_READ | PROT_WRITE, MAP_SHARED, m_fd, 0);
+	if (p == MAP_FAILED) {
+		LogError("Cannot map the last heard shared memory %s", m_name.c_str());
+		::close(m_fd);
+		m_fd = -1;
+		return false;
+	}
+
+	m_memory = (CLastHeardMemory*)p;
+
+	// A reader still mapped from an earlier run stops on the magic until this is all reset
+	m_memory->m_magic.store(0U, std::memory_order_release);
+
+	m_memory->m_version   = LASTHEARD_VERSION;
+	m_memory->m_entries   = LASTHEARD_ENTRIES;
+	m_memory->m_entrySize = sizeof(CLastHeardEntry);
+	m_memory->m_started   = (uint32_t)::time(NULL);
+	m_memory->m_count.store(0U, std::memory_order_relaxed);
+
+	for (unsigned int i = 0U; i < LASTHEARD_ENTRIES; i++) {
+		m_memory->m_entry[i].m_seq.store(0U, std::memory_order_relaxed);
+		m_memory->m_entry[i].m_index = 0U;
+		::memset(&m_memory->m_entry[i].m_event, 0x00U, sizeof(CLastHeardEvent));
+	}
+
+	m_memory->m_magic.store(LASTHEARD_MAGIC, std::memory_order_release);
+
+	LogMessage("Last heard published in shared memory %s", m_name.c_str());
+
+	return true;
+}
+
+// Both the YSF and the DMR ingress threads write here, the mutex keeps the
+// ring to the one writer that the sequence locks assume
+void CLastHeard::write(CLastHeardEvent& event)
+{
+	if (m_memory == NULL)
+		return;
+
+	struct timeval now;
+	::gettimeofday(&now, NULL);
+	event.m_time = uint64_t(now.tv_sec) * 1000U + uint64_t(now.tv_usec) / 1000U;
+
+	m_mutex.lock();
+
+	uint32_t count = m_memory->m_count.load(std::memory_order_relaxed);
+	CLastHeardEntry& entry = m_memory->m_entry[count % LASTHEARD_ENTRIES];
+
+	uint32_t seq = entry.m_seq.load(std::memory_order_relaxed);
+	entry.m_seq.store(seq + 1U, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+
+	entry.m_index = count;
+	::memcpy(&entry.m_event, &event, sizeof(CLastHeardEvent));
+
+	entry.m_seq.store(seq + 2U, std::memory_order_release);
+	m_memory->m_count.store(count + 1U, std::memory_order_release);
+
+	m_mutex.unlock();
+}
+
+// The segment is left in place, so a dashboard that still has it mapped
+// carries on by itself once YSF2DMR is started again
+void CLastHeard::close()
+{
+	if (m_memory != NULL) {
+		::munmap(m_memory, sizeof(CLastHeardMemory));
+		m_memory = NULL;
+	}
+
+	if (m_fd >= 0) {
+		::close(m_fd);
+		m_fd = -1;
+	}
+}
+#endif
+
+void CLastHeard::setCallsign(char* field, const std::string& callsign)
+{
+	assert(field != NULL);
+
+	std::string cs = callsign;
+	cs.erase(cs.find_last_not_of(' ') + 1U);
+
+	::memset(field, 0x00U, LASTHEARD_CALLSIGN_LENGTH);
+	::strncpy(field, cs.c_str(), LASTHEARD_CALLSIGN_LENGTH - 1U);
+}
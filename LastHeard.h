@@ -0,0 +1,50 @@
+/*
+*   Copyright (C) 2018 by Andy Uribe CA6JAU
+*
+*   This program is free software; you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation; either version 2 of the License, or
+*   (at your option) any later version.
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program; if not, write to the Free Software
+*   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+*/
+
+#if !defined(LastHeard_H)
+#define	LastHeard_H
+
+#include "LastHeardDefines.h"
+#include "Mutex.h"
+
+#include <string>
+
+// Publishes the start and end of every call into a ring in POSIX shared
+// memory, so that a dashboard can follow the traffic without reading the log
+class CLastHeard {
+public:
+	CLastHeard(const std::string& name);
+	~CLastHeard();
+
+	bool open();
+
+	// The time is filled in here, callsigns longer than the field are cut
+	void write(CLastHeardEvent& event);
+
+	void close();
+
+	static void setCallsign(char* field, const std::string& callsign);
+
+private:
+	std::string       m_name;
+	int               m_fd;
+	CLastHeardMemory* m_memory;
+	CMutex            m_mutex;
+};
+
+#endif
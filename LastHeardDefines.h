@@ -0,0 +1,78 @@
+/*
+*   Copyright (C) 2018 by Andy Uribe CA6JAU
+*
+*   This program is free software; you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation; either version 2 of the License, or
+*   (at your option) any later version.
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program; if not, write to the Free Software
+*   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+*/
+
+#if !defined(LastHeardDefines_H)
+#define	LastHeardDefines_H
+
+// The layout of the last heard shared memory, written by YSF2DMR and polled
+// by dashboards through CLastHeardReader. Only fixed width types and 32 bit
+// atomics are used so that it is the same, and lock free, on every platform.
+
+#include <atomic>
+#include <cstdint>
+
+const uint32_t LASTHEARD_MAGIC   = 0x4C485946U;	// "FYHL"
+const uint32_t LASTHEARD_VERSION = 1U;
+
+const unsigned int LASTHEARD_ENTRIES         = 128U;
+const unsigned int LASTHEARD_CALLSIGN_LENGTH = 16U;
+
+enum LASTHEARD_EVENT {
+	LHE_START = 1,
+	LHE_END   = 2
+};
+
+enum LASTHEARD_DIRECTION {
+	LHD_YSF_TO_DMR = 1,
+	LHD_DMR_TO_YSF = 2
+};
+
+struct CLastHeardEvent {
+	uint64_t m_time;		// Unix time of the event in ms
+	uint32_t m_event;		// LASTHEARD_EVENT
+	uint32_t m_direction;	// LASTHEARD_DIRECTION
+	uint32_t m_slotNo;
+	uint32_t m_srcId;
+	uint32_t m_dstId;
+	uint32_t m_group;		// 1 for a talk group, 0 for a private call
+	uint32_t m_duration;	// In ms, the rest are only filled in at the end
+	uint32_t m_frames;
+	uint32_t m_lost;
+	uint32_t m_ber;			// In hundredths of a percent, DMR calls only
+	char     m_srcCallsign[LASTHEARD_CALLSIGN_LENGTH];
+	char     m_dstCallsign[LASTHEARD_CALLSIGN_LENGTH];
+};
+
+// Each entry has its own sequence lock, odd while the writer is inside it
+struct CLastHeardEntry {
+	std::atomic<uint32_t> m_seq;
+	uint32_t              m_index;		// The event count when it was written
+	CLastHeardEvent       m_event;
+};
+
+struct CLastHeardMemory {
+	std::atomic<uint32_t> m_magic;		// Written last, once the rest is set up
+	uint32_t              m_version;
+	uint32_t              m_entries;
+	uint32_t              m_entrySize;
+	uint32_t              m_started;	// Unix time YSF2DMR started, a change means a restart
+	std::atomic<uint32_t> m_count;		// Events written, the newest is at (m_count - 1) % m_entries
+	CLastHeardEntry       m_entry[LASTHEARD_ENTRIES];
+};
+
+#endif
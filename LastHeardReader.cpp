@@ -0,0 +1,181 @@
+/*
+*   Copyright (C) 2018 by Andy Uribe CA6JAU
+*
+*   This program is free software; you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation; either version 2 of the License, or
+*   (at your option) any later version.
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program; if not, write to the Free Software
+*   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+*/
+
+#include "LastHeardReader.h"
+
+#include <cstring>
+#include <cassert>
+
+#if !defined(_WIN32) && !defined(_WIN64)
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+CLastHeardReader::CLastHeardReader(const std::string& name) :
+m_name(name),
+m_fd(-1),
+m_memory(NULL),
+m_started(0U),
+m_next(0U),
+m_missed(0U)
+{
+	assert(!name.empty());
+}
+
+CLastHeardReader::~CLastHeardReader()
+{
+	close();
+}
+
+bool CLastHeardReader::open()
+{
+#if defined(_WIN32) || defined(_WIN64)
+	return false;
+#else
+	m_fd = ::shm_open(m_name.c_str(), O_RDONLY, 0);
+	if (m_fd < 0)
+		return false;
+
+	struct stat st;
+	if (::fstat(m_fd, &st) < 0 || st.st_size < off_t(sizeof(CLastHeardMemory))) {
+		close();
+		return false;
+	}
+
+	void* p = ::mmap(NULL, sizeof(CLastHeardMemory), PROT_READ, MAP_SHARED, m_fd, 0);
+	if (p == MAP_FAILED) {
+		close();
+		return false;
+	}
+
+	m_memory = (const CLastHeardMemory*)p;
+
+	if (m_memory->m_magic.load(std::memory_order_acquire) == LASTHEARD_MAGIC &&
+	    (m_memory->m_version != LASTHEARD_VERSION || m_memory->m_entrySize != sizeof(CLastHeardEntry))) {
+		close();
+		return false;
+	}
+
+	m_started = 0U;
+	m_next    = 0U;
+	m_missed  = 0U;
+
+	return true;
+#endif
+}
+
+unsigned int CLastHeardReader::read(CLastHeardEvent* events, unsigned int count)
+{
+	assert(events != NULL);
+
+	if (m_memory == NULL || m_memory->m_magic.load(std::memory_order_acquire) != LASTHEARD_MAGIC)
+		return 0U;
+
+	uint32_t written = m_memory->m_count.load(std::memory_order_acquire);
+
+	if (m_memory->m_started != m_started || m_next > written) {
+		m_started = m_memory->m_started;
+		m_next    = 0U;
+	}
+
+	if (written - m_next > LASTHEARD_ENTRIES) {
+		m_missed += written - m_next - LASTHEARD_ENTRIES;
+		m_next    = written - LASTHEARD_ENTRIES;
+	}
+
+	unsigned int n = 0U;
+	while (m_next != written && n < count) {
+		if (copy(m_next, events[n]))
+			n++;
+		else
+			m_missed++;
+
+		m_next++;
+	}
+
+	return n;
+}
+
+unsigned int CLastHeardReader::getLatest(CLastHeardEvent* events, unsigned int count) const
+{
+	assert(events != NULL);
+
+	if (m_memory == NULL || m_memory->m_magic.load(std::memory_order_acquire) != LASTHEARD_MAGIC)
+		return 0U;
+
+	uint32_t written = m_memory->m_count.load(std::memory_order_acquire);
+
+	if (count > LASTHEARD_ENTRIES)
+		count = LASTHEARD_ENTRIES;
+	if (count > written)
+		count = written;
+
+	unsigned int n = 0U;
+	for (uint32_t index = written - count; index != written; index++) {
+		if (copy(index, events[n]))
+			n++;
+	}
+
+	return n;
+}
+
+unsigned int CLastHeardReader::getMissed() const
+{
+	return m_missed;
+}
+
+void CLastHeardReader::close()
+{
+#if !defined(_WIN32) && !defined(_WIN64)
+	if (m_memory != NULL) {
+		::munmap((void*)m_memory, sizeof(CLastHeardMemory));
+		m_memory = NULL;
+	}
+
+	if (m_fd >= 0) {
+		::close(m_fd);
+		m_fd = -1;
+	}
+#endif
+}
+
+// False when the writer has already moved on to a newer event in this entry,
+// or never finished writing it because it died part way through
+bool CLastHeardReader::copy(uint32_t index, CLastHeardEvent& event) const
+{
+	const CLastHeardEntry& entry = m_memory->m_entry[index % LASTHEARD_ENTRIES];
+
+	for (unsigned int tries = 0U; tries < 10000U; tries++) {
+		uint32_t seq1 = entry.m_seq.load(std::memory_order_acquire);
+		if ((seq1 & 0x01U) == 0x01U)
+			continue;
+
+		uint32_t written = entry.m_index;
+		::memcpy(&event, &entry.m_event, sizeof(CLastHeardEvent));
+
+		std::atomic_thread_fence(std::memory_order_acquire);
+
+		uint32_t seq2 = entry.m_seq.load(std::memory_order_relaxed);
+		if (seq1 == seq2)
+			return written == index;
+	}
+
+	return false;
+}
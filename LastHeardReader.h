@@ -0,0 +1,60 @@
+/*
+*   Copyright (C) 2018 by Andy Uribe CA6JAU
+*
+*   This program is free software; you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation; either version 2 of the License, or
+*   (at your option) any later version.
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program; if not, write to the Free Software
+*   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+*/
+
+#if !defined(LastHeardReader_H)
+#define	LastHeardReader_H
+
+#include "LastHeardDefines.h"
+
+#include <string>
+
+// The dashboard side of the last heard shared memory. It only maps the
+// segment read only and never blocks the writer, a copy that was changed
+// while being taken is simply taken again. Link with liblastheard.a.
+class CLastHeardReader {
+public:
+	CLastHeardReader(const std::string& name);
+	~CLastHeardReader();
+
+	bool open();
+
+	// Copies the events written since the previous call, oldest first, and
+	// returns how many. Events overwritten before being read are counted in
+	// getMissed(), a restart of YSF2DMR starts again from its first event.
+	unsigned int read(CLastHeardEvent* events, unsigned int count);
+
+	// Copies up to count of the newest events, oldest first, without moving
+	// on where read() carries on from
+	unsigned int getLatest(CLastHeardEvent* events, unsigned int count) const;
+
+	unsigned int getMissed() const;
+
+	void close();
+
+private:
+	std::string             m_name;
+	int                     m_fd;
+	const CLastHeardMemory* m_memory;
+	uint32_t                m_started;
+	uint32_t                m_next;
+	unsigned int            m_missed;
+
+	bool copy(uint32_t index, CLastHeardEvent& event) const;
+};
+
+#endif
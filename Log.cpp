@@ -17,6 +17,7 @@
  */
 
 #include "Log.h"
+#include "Mutex.h"
 
 #if defined(_WIN32) || defined(_WIN64)
 #include <Windows.h>
@@ -43,6 +44,9 @@ static struct tm m_tm;
 
 static char LEVELS[] = " DMIWEF";
 
+// The voice pipeline logs from several threads
+static CMutex m_mutex;
+
 static bool LogOpen()
 {
 	if (m_fileLevel == 0U)
@@ -74,13 +78,28 @@ static bool LogOpen()
     return m_fpLog != NULL;
 }
 
+// May be called again while running, the next line goes to the new file
 bool LogInitialise(const std::string& filePath, const std::string& fileRoot, unsigned int fileLevel, unsigned int displayLevel)
 {
+	m_mutex.lock();
+
+	if (m_fpLog != NULL) {
+		::fclose(m_fpLog);
+		m_fpLog = NULL;
+	}
+
+	::memset(&m_tm, 0x00, sizeof(struct tm));
+
 	m_filePath     = filePath;
 	m_fileRoot     = fileRoot;
 	m_fileLevel    = fileLevel;
 	m_displayLevel = displayLevel;
-    return ::LogOpen();
+
+	bool ret = ::LogOpen();
+
+	m_mutex.unlock();
+
+	return ret;
 }
 
 void LogFinalise()
@@ -94,6 +113,9 @@ void Log(unsigned int level, const char* fmt, ...)
     assert(fmt != NULL);
 
 	char buffer[300U];
+
+	m_mutex.lock();
+
 #if defined(_WIN32) || defined(_WIN64)
 	SYSTEMTIME st;
 	::GetSystemTime(&st);
@@ -117,8 +139,10 @@ void Log(unsigned int level, const char* fmt, ...)
 
 	if (level >= m_fileLevel && m_fileLevel != 0U) {
 		bool ret = ::LogOpen();
-		if (!ret)
+		if (!ret) {
+			m_mutex.unlock();
 			return;
+		}
 
 		::fprintf(m_fpLog, "%s\n", buffer);
 		::fflush(m_fpLog);
@@ -133,4 +157,6 @@ void Log(unsigned int level, const char* fmt, ...)
         ::fclose(m_fpLog);
         exit(1);
     }
+
+	m_mutex.unlock();
 }
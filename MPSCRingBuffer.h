@@ -0,0 +1,186 @@
+/*
+ *   Copyright (C) 2018 by Andy Uribe CA6JAU
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#ifndef MPSCRingBuffer_H
+#define MPSCRingBuffer_H
+
+#include "SPSCRingBuffer.h"
+#include "Log.h"
+
+#include <cstdio>
+#include <cassert>
+#include <cstring>
+#include <atomic>
+
+// A ring buffer that may be written by any number of threads and read by
+// exactly one thread without locking. Producers reserve their slots with a
+// compare and swap on the input pointer, then publish each slot through its
+// sequence number, which the consumer waits on before reading it. A call to
+// addData() reserves all its slots at once, so its data stays contiguous.
+template<class T> class CMPSCRingBuffer {
+	static_assert(std::is_trivially_copyable<T>::value, "CMPSCRingBuffer moves its elements with memcpy");
+
+public:
+	CMPSCRingBuffer(unsigned int length, const char* name) :
+	m_length(ringBufferLength(length < 2U ? 2U : length)),
+	m_mask(m_length - 1U),
+	m_name(name),
+	m_buffer(NULL),
+	m_seq(NULL),
+	m_iPtr(0U),
+	m_oPtr(0U)
+	{
+		assert(length > 0U);
+		assert(name != NULL);
+
+		m_buffer = new T[m_length];
+		m_seq    = new std::atomic<unsigned int>[m_length];
+
+		::memset(m_buffer, 0x00, m_length * sizeof(T));
+
+		for (unsigned int i = 0U; i < m_length; i++)
+			m_seq[i].store(i, std::memory_order_relaxed);
+	}
+
+	~CMPSCRingBuffer()
+	{
+		delete[] m_buffer;
+		delete[] m_seq;
+	}
+
+	bool addData(const T* buffer, unsigned int nSamples)
+	{
+		assert(nSamples > 0U && nSamples <= m_length);
+
+		unsigned int iPtr = m_iPtr.load(std::memory_order_relaxed);
+
+		for (;;) {
+			// The consumer frees slots in order, so if the last one is free they all are
+			unsigned int last = iPtr + nSamples - 1U;
+			int diff = int(m_seq[last & m_mask].load(std::memory_order_acquire) - last);
+
+			if (diff == 0) {
+				if (m_iPtr.compare_exchange_weak(iPtr, iPtr + nSamples, std::memory_order_relaxed))
+					break;
+			} else if (diff < 0) {
+				LogError("%s buffer overflow, dropping the new data. (%u > %u)", m_name, nSamples, freeSpace());
+				return false;
+			} else {
+				iPtr = m_iPtr.load(std::memory_order_relaxed);
+			}
+		}
+
+		for (unsigned int i = 0U; i < nSamples; i++) {
+			unsigned int pos = (iPtr + i) & m_mask;
+			::memcpy(m_buffer + pos, buffer + i, sizeof(T));
+			m_seq[pos].store(iPtr + i + 1U, std::memory_order_release);
+		}
+
+		return true;
+	}
+
+	bool getData(T* buffer, unsigned int nSamples)
+	{
+		if (!peek(buffer, nSamples))
+			return false;
+
+		unsigned int oPtr = m_oPtr.load(std::memory_order_relaxed);
+
+		for (unsigned int i = 0U; i < nSamples; i++)
+			m_seq[(oPtr + i) & m_mask].store(oPtr + i + m_length, std::memory_order_release);
+
+		m_oPtr.store(oPtr + nSamples, std::memory_order_release);
+
+		return true;
+	}
+
+	bool peek(T* buffer, unsigned int nSamples)
+	{
+		unsigned int oPtr = m_oPtr.load(std::memory_order_relaxed);
+
+		// Only slots that have been published count, not those still being written
+		for (unsigned int i = 0U; i < nSamples; i++) {
+			if (m_seq[(oPtr + i) & m_mask].load(std::memory_order_acquire) != oPtr + i + 1U) {
+				LogError("**** Underflow in %s ring buffer, %u < %u", m_name, i, nSamples);
+				return false;
+			}
+		}
+
+		unsigned int pos   = oPtr & m_mask;
+		unsigned int first = m_length - pos;
+		if (first > nSamples)
+			first = nSamples;
+
+		::memcpy(buffer, m_buffer + pos, first * sizeof(T));
+		::memcpy(buffer + first, m_buffer, (nSamples - first) * sizeof(T));
+
+		return true;
+	}
+
+	void clear()
+	{
+		T data;
+		while (hasData())
+			getData(&data, 1U);
+	}
+
+	unsigned int freeSpace() const
+	{
+		return m_length - dataSize();
+	}
+
+	// Includes slots that have been reserved but not yet published
+	unsigned int dataSize() const
+	{
+		unsigned int oPtr = m_oPtr.load(std::memory_order_acquire);
+		unsigned int iPtr = m_iPtr.load(std::memory_order_acquire);
+
+		return iPtr - oPtr;
+	}
+
+	bool hasSpace(unsigned int length) const
+	{
+		return freeSpace() >= length;
+	}
+
+	bool hasData() const
+	{
+		unsigned int oPtr = m_oPtr.load(std::memory_order_relaxed);
+
+		return m_seq[oPtr & m_mask].load(std::memory_order_acquire) == oPtr + 1U;
+	}
+
+	bool isEmpty() const
+	{
+		return !hasData();
+	}
+
+private:
+	unsigned int               m_length;
+	unsigned int               m_mask;
+	const char*                m_name;
+	T*                         m_buffer;
+	std::atomic<unsigned int>* m_seq;
+	char                       m_pad1[RING_CACHE_LINE];
+	std::atomic<unsigned int>  m_iPtr;
+	char                       m_pad2[RING_CACHE_LINE - sizeof(std::atomic<unsigned int>)];
+	std::atomic<unsigned int>  m_oPtr;
+	char                       m_pad3[RING_CACHE_LINE - sizeof(std::atomic<unsigned int>)];
+};
+
+#endif
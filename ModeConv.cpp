@@ -471,6 +471,8 @@ m_dmrN(0U),
 m_YSF(5000U, "DMR2YSF"),
 m_DMR(5000U, "YSF2DMR")
 {
+	m_YSF.setOverflow(RBO_DROP_OLDEST, YSF_RECORD_LENGTH);
+	m_DMR.setOverflow(RBO_DROP_OLDEST, DMR_RECORD_LENGTH);
 }
 
 CModeConv::~CModeConv()
@@ -590,11 +592,8 @@ void CModeConv::putAMBE2YSF(unsigned int a, unsigned int b, unsigned int dat_c)
 		WRITE_BIT(ysfFrame, n, s);
 	}
 
-	m_YSF.addData(&TAG_DATA, 1U);
-	m_YSF.addData(ysfFrame, 13U);
+	writeYSF(TAG_DATA, ysfFrame);
 	//CUtils::dump(1U, "VCH V/D type 2:", ysfFrame, 13U);
-	
-	m_ysfN += 1U;
 }
 
 void CModeConv::putYSF(unsigned char* data)
@@ -679,12 +678,9 @@ void CModeConv::putAMBE2DMR(unsigned int dat_a, unsigned int dat_b, unsigned int
 		WRITE_BIT(v_dmr, cPos, dat_c & MASK);
 	}
 
-	m_DMR.addData(&TAG_DATA, 1U);
-	m_DMR.addData(v_dmr, 9U);
+	writeDMR(TAG_DATA, v_dmr);
 
 	//CUtils::dump(1U, "DMR Voice:", v_dmr, 9U);
-	
-	m_dmrN += 1U;
 }
 
 void CModeConv::putDMRHeader()
@@ -693,9 +689,7 @@ void CModeConv::putDMRHeader()
 
 	::memset(vch, 0, 13U);
 
-	m_YSF.addData(&TAG_HEADER, 1U);
-	m_YSF.addData(vch, 13U);
-	m_ysfN += 1U;
+	writeYSF(TAG_HEADER, vch);
 }
 
 void CModeConv::putDMREOT()
@@ -706,14 +700,10 @@ void CModeConv::putDMREOT()
 	
 	unsigned int fill = 5U - (m_ysfN % 5U);
 	for (unsigned int i = 0U; i < fill; i++) {
-		m_YSF.addData(&TAG_DATA, 1U);
-		m_YSF.addData(YSF_SILENCE, 13U);
-		m_ysfN += 1U;
+		writeYSF(TAG_DATA, YSF_SILENCE);
 	}
 
-	m_YSF.addData(&TAG_EOT, 1U);
-	m_YSF.addData(vch, 13U);
-	m_ysfN += 1U;
+	writeYSF(TAG_EOT, vch);
 }
 
 void CModeConv::putYSFHeader()
@@ -722,9 +712,7 @@ void CModeConv::putYSFHeader()
 
 	::memset(v_dmr, 0U, 9U);
 
-	m_DMR.addData(&TAG_HEADER, 1U);
-	m_DMR.addData(v_dmr, 9U);
-	m_dmrN += 1U;
+	writeDMR(TAG_HEADER, v_dmr);
 }
 
 void CModeConv::putYSFEOT()
@@ -735,14 +723,10 @@ void CModeConv::putYSFEOT()
 	
 	unsigned int fill = 3U - (m_dmrN % 3U);
 	for (unsigned int i = 0U; i < fill; i++) {
-		m_DMR.addData(&TAG_DATA, 1U);
-		m_DMR.addData(DMR_SILENCE, 9U);
-		m_dmrN += 1U;
+		writeDMR(TAG_DATA, DMR_SILENCE);
 	}
 
-	m_DMR.addData(&TAG_EOT, 1U);
-	m_DMR.addData(v_dmr, 9U);
-	m_dmrN += 1U;
+	writeDMR(TAG_EOT, v_dmr);
 }
 
 unsigned int CModeConv::getDMR(unsigned char* data)
@@ -837,3 +821,40 @@ unsigned int CModeConv::getYSF(unsigned char* data)
 	else
 		return TAG_NODATA;
 }
+
+// The number of whole network frames waiting, five VCH per YSF frame and
+// three AMBE+2 frames per DMR burst
+unsigned int CModeConv::getYSFFrames() const
+{
+	return m_ysfN / 5U;
+}
+
+unsigned int CModeConv::getDMRFrames() const
+{
+	return m_dmrN / 3U;
+}
+
+// Each record is added with one call so that an overflow only ever drops whole
+// records, and the record counts are taken from the buffers afterwards as the
+// overflow policy may have dropped some
+void CModeConv::writeYSF(unsigned char tag, const unsigned char* data)
+{
+	unsigned char record[YSF_RECORD_LENGTH];
+	record[0U] = tag;
+	::memcpy(record + 1U, data, YSF_RECORD_LENGTH - 1U);
+
+	m_YSF.addData(record, YSF_RECORD_LENGTH);
+
+	m_ysfN = m_YSF.dataSize() / YSF_RECORD_LENGTH;
+}
+
+void CModeConv::writeDMR(unsigned char tag, const unsigned char* data)
+{
+	unsigned char record[DMR_RECORD_LENGTH];
+	record[0U] = tag;
+	::memcpy(record + 1U, data, DMR_RECORD_LENGTH - 1U);
+
+	m_DMR.addData(record, DMR_RECORD_LENGTH);
+
+	m_dmrN = m_DMR.dataSize() / DMR_RECORD_LENGTH;
+}
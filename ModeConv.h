@@ -24,6 +24,10 @@
 #if !defined(MODECONV_H)
 #define MODECONV_H
 
+// A tag followed by one VCH or one AMBE+2 voice frame
+const unsigned int YSF_RECORD_LENGTH = 14U;
+const unsigned int DMR_RECORD_LENGTH = 10U;
+
 class CModeConv {
 public:
 	CModeConv();
@@ -40,9 +44,14 @@ public:
 	unsigned int getYSF(unsigned char* bytes);
 	unsigned int getDMR(unsigned char* bytes);
 
+	unsigned int getYSFFrames() const;
+	unsigned int getDMRFrames() const;
+
 private:
 	void putAMBE2YSF(unsigned int a, unsigned int b, unsigned int dat_c);
 	void putAMBE2DMR(unsigned int dat_a, unsigned int dat_b, unsigned int dat_c);
+	void writeYSF(unsigned char tag, const unsigned char* data);
+	void writeDMR(unsigned char tag, const unsigned char* data);
 	unsigned int m_ysfN;
 	unsigned int m_dmrN;
 	CRingBuffer<unsigned char> m_YSF;
@@ -26,29 +26,69 @@
 #include <cstring>
 #include <cctype>
 
-CReflectors::CReflectors(const std::string& hostsFile, unsigned int reloadTime) :
-m_hostsFile(hostsFile),
+CReflectorTable::CReflectorTable(std::vector<CReflector>& reflectors) :
 m_reflectors(),
-m_timer(1000U, reloadTime * 60U)
+m_index(),
+m_mask(0U)
 {
-    if (reloadTime > 0U)
-        m_timer.start();
+	m_reflectors.swap(reflectors);
+
+	// At most half full, so that a probe ends quickly
+	unsigned int slots = 16U;
+	while (slots < m_reflectors.size() * 2U)
+		slots *= 2U;
+
+	m_index.resize(slots, 0U);
+	m_mask = slots - 1U;
+
+	for (unsigned int i = 0U; i < m_reflectors.size(); i++) {
+		unsigned int id   = m_reflectors[i].m_id;
+		unsigned int slot = (id * 2654435761U) & m_mask;
+
+		// The first of any repeated id is the one found, as before
+		while (m_index[slot] != 0U && m_reflectors[m_index[slot] - 1U].m_id != id)
+			slot = (slot + 1U) & m_mask;
+
+		if (m_index[slot] == 0U)
+			m_index[slot] = i + 1U;
+	}
 }
 
-CReflectors::~CReflectors()
+const CReflector* CReflectorTable::find(unsigned int id) const
 {
-	for (std::vector<CReflector*>::iterator it = m_reflectors.begin(); it != m_reflectors.end(); ++it)
-		delete *it;
+	unsigned int slot = (id * 2654435761U) & m_mask;
 
-	m_reflectors.clear();
+	while (m_index[slot] != 0U) {
+		const CReflector& reflector = m_reflectors[m_index[slot] - 1U];
+		if (reflector.m_id == id)
+			return &reflector;
+
+		slot = (slot + 1U) & m_mask;
+	}
+
+	return NULL;
 }
 
-bool CReflectors::load()
+unsigned int CReflectorTable::size() const
 {
-	for (std::vector<CReflector*>::iterator it = m_reflectors.begin(); it != m_reflectors.end(); ++it)
-		delete *it;
+	return m_reflectors.size();
+}
 
-	m_reflectors.clear();
+CReflectors::CReflectors(const std::string& hostsFile) :
+m_hostsFile(hostsFile),
+m_table()
+{
+}
+
+CReflectors::~CReflectors()
+{
+}
+
+// Built aside on the caller's thread, a lookup under way keeps the old table
+// alive until it has finished with it
+bool CReflectors::load()
+{
+	std::vector<CReflector> reflectors;
 
 	FILE* fp = ::fopen(m_hostsFile.c_str(), "rt");
 	if (fp != NULL) {
@@ -62,45 +102,48 @@ bool CReflectors::load()
 			char* p3 = ::strtok(NULL, "\r\n");
 
 			if (p1 != NULL && p2 != NULL && p3 != NULL) {
-				CReflector* refl = new CReflector;
-				refl->m_id       = (unsigned int)::atoi(p1);
-				refl->m_address  = std::string(p2);
-				refl->m_startup  = (unsigned int)::atoi(p3);
-				m_reflectors.push_back(refl);
+				CReflector refl;
+				refl.m_id      = (unsigned int)::atoi(p1);
+				refl.m_address = std::string(p2);
+				refl.m_startup = (unsigned int)::atoi(p3);
+				reflectors.push_back(refl);
 			}
 		}
 
 		::fclose(fp);
 	}
 
-	size_t size = m_reflectors.size();
+	size_t size = reflectors.size();
 	LogInfo("Loaded %u XLX reflectors", size);
 
-	size = m_reflectors.size();
 	if (size == 0U)
 		return false;
 
+	std::shared_ptr<const CReflectorTable> table(new CReflectorTable(reflectors));
+	std::atomic_store(&m_table, table);
+
 	return true;
 }
 
-CReflector* CReflectors::find(unsigned int id)
+bool CReflectors::find(unsigned int id, CReflector& reflector) const
 {
-	for (std::vector<CReflector*>::iterator it = m_reflectors.begin(); it != m_reflectors.end(); ++it) {
-		if (id == (*it)->m_id)
-			return *it;
+	std::shared_ptr<const CReflectorTable> table = std::atomic_load(&m_table);
+
+	const CReflector* refl = NULL;
+	if (table != NULL)
+		refl = table->find(id);
+
+	if (refl == NULL) {
+		LogMessage("Trying to find non existent XLX reflector with an id of %u", id);
+		return false;
 	}
 
-	LogMessage("Trying to find non existent XLX reflector with an id of %u", id);
+	reflector = *refl;
 
-	return NULL;
+	return true;
 }
 
-void CReflectors::clock(unsigned int ms)
+void CReflectors::fileChanged(const std::string&)
 {
-    m_timer.clock(ms);
-
-    if (m_timer.isRunning() && m_timer.hasExpired()) {
-        load();
-        m_timer.start();
-    }
+	load();
 }
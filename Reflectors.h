@@ -19,9 +19,10 @@
 #if !defined(Reflectors_H)
 #define	Reflectors_H
 
-#include "Timer.h"
+#include "FileWatcher.h"
 
 #include <vector>
+#include <memory>
 #include <string>
 
 class CReflector {
@@ -38,21 +39,39 @@ public:
 	unsigned int m_startup;
 };
 
-class CReflectors {
+// Never changed once built, a reload builds a new one. The reflectors are
+// kept in one block, with an open addressed index on their ids.
+class CReflectorTable {
 public:
-	CReflectors(const std::string& hostsFile, unsigned int reloadTime);
-	~CReflectors();
+	CReflectorTable(std::vector<CReflector>& reflectors);
+
+	const CReflector* find(unsigned int id) const;
+
+	unsigned int size() const;
+
+private:
+	std::vector<CReflector>   m_reflectors;
+	std::vector<unsigned int> m_index;	// One more than the position in m_reflectors, 0 for an empty slot
+	unsigned int              m_mask;
+};
+
+// Loaded again by the file watcher whenever the hosts file changes, into a
+// new table that replaces the old one for later lookups
+class CReflectors : public CFileListener {
+public:
+	CReflectors(const std::string& hostsFile);
+	virtual ~CReflectors();
 
 	bool load();
 
-	CReflector* find(unsigned int id);
+	// A copy, so that it outlives a reload
+	bool find(unsigned int id, CReflector& reflector) const;
 
-    void clock(unsigned int ms);
+	virtual void fileChanged(const std::string& fileName);
 
 private:
-	std::string              m_hostsFile;
-	std::vector<CReflector*> m_reflectors;
-    CTimer                   m_timer;
+	std::string                            m_hostsFile;
+	std::shared_ptr<const CReflectorTable> m_table;	// Only used through std::atomic_load/store
 };
 
 #endif
@@ -0,0 +1,175 @@
+/*
+*   Copyright (C) 2018 by Andy Uribe CA6JAU
+*
+*   This program is free software; you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation; either version 2 of the License, or
+*   (at your option) any later version.
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program; if not, write to the Free Software
+*   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+*/
+
+#include "Resolver.h"
+#include "StopWatch.h"
+#include "Log.h"
+
+#include <cstdio>
+#include <cassert>
+
+// How long an address, or the failure to find one, is trusted for
+const time_t RESOLVER_TTL          = 300;
+const time_t RESOLVER_NEGATIVE_TTL = 30;
+
+CResolver* CResolver::s_resolver = NULL;
+
+CResolverEntry::CResolverEntry() :
+m_address(),
+m_valid(false),
+m_pending(false),
+m_expiry(0)
+{
+	m_address.s_addr = INADDR_NONE;
+}
+
+CResolver::CResolver() :
+CThread(),
+m_entries(),
+m_requests(),
+m_mutex(),
+m_stop(false)
+{
+}
+
+void CResolver::start()
+{
+	if (s_resolver != NULL)
+		return;
+
+	s_resolver = new CResolver;
+	s_resolver->setName("resolver");
+	s_resolver->run();
+
+	LogMessage("Started the DNS resolver thread");
+}
+
+void CResolver::stop()
+{
+	if (s_resolver == NULL)
+		return;
+
+	s_resolver->m_stop = true;
+	s_resolver->wait();
+
+	delete s_resolver;
+	s_resolver = NULL;
+
+	LogMessage("Stopped the DNS resolver thread");
+}
+
+bool CResolver::lookup(const std::string& host, in_addr& address)
+{
+	assert(!host.empty());
+
+	// Dotted quads need no help
+	address.s_addr = ::inet_addr(host.c_str());
+	if (address.s_addr != INADDR_NONE)
+		return true;
+
+	// Without the thread there is nobody to ask, so ask directly
+	if (s_resolver == NULL) {
+		address = CUDPSocket::lookup(host);
+		return address.s_addr != INADDR_NONE;
+	}
+
+	bool pending;
+	return s_resolver->find(host, address, pending);
+}
+
+in_addr CResolver::resolve(const std::string& host, unsigned int timeout)
+{
+	assert(!host.empty());
+
+	in_addr address;
+	if (lookup(host, address) || s_resolver == NULL)
+		return address;
+
+	CStopWatch stopWatch;
+	stopWatch.start();
+
+	for (;;) {
+		bool pending;
+		if (s_resolver->find(host, address, pending) || !pending)
+			return address;
+
+		if (stopWatch.elapsed() >= timeout) {
+			LogWarning("Timed out waiting for the address of %s", host.c_str());
+			return address;
+		}
+
+		CThread::sleep(10U);
+	}
+}
+
+bool CResolver::find(const std::string& host, in_addr& address, bool& pending)
+{
+	m_mutex.lock();
+
+	CResolverEntry& entry = m_entries[host];
+
+	if (!entry.m_pending && ::time(NULL) >= entry.m_expiry) {
+		entry.m_pending = true;
+		m_requests.push_back(host);
+	}
+
+	address = entry.m_address;
+	pending = entry.m_pending;
+	bool valid = entry.m_valid;
+
+	m_mutex.unlock();
+
+	return valid;
+}
+
+void CResolver::entry()
+{
+	while (!m_stop) {
+		m_mutex.lock();
+
+		if (m_requests.empty()) {
+			m_mutex.unlock();
+			CThread::sleep(10U);
+			continue;
+		}
+
+		std::string host = m_requests.front();
+		m_requests.pop_front();
+
+		m_mutex.unlock();
+
+		// The only blocking call, made without holding the lock
+		in_addr address = CUDPSocket::lookup(host);
+
+		m_mutex.lock();
+
+		CResolverEntry& entry = m_entries[host];
+		entry.m_pending = false;
+
+		if (address.s_addr != INADDR_NONE) {
+			entry.m_address = address;
+			entry.m_valid   = true;
+			entry.m_expiry  = ::time(NULL) + RESOLVER_TTL;
+		} else {
+			// Keep the last good address, the host may only be briefly unknown
+			entry.m_expiry  = ::time(NULL) + RESOLVER_NEGATIVE_TTL;
+		}
+
+		m_mutex.unlock();
+	}
+}
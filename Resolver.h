@@ -0,0 +1,71 @@
+/*
+*   Copyright (C) 2018 by Andy Uribe CA6JAU
+*
+*   This program is free software; you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation; either version 2 of the License, or
+*   (at your option) any later version.
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program; if not, write to the Free Software
+*   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+*/
+
+#if !defined(Resolver_H)
+#define	Resolver_H
+
+#include "UDPSocket.h"
+#include "Thread.h"
+#include "Mutex.h"
+
+#include <string>
+#include <deque>
+#include <map>
+#include <ctime>
+#include <atomic>
+
+class CResolverEntry {
+public:
+	CResolverEntry();
+
+	in_addr m_address;
+	bool    m_valid;
+	bool    m_pending;
+	time_t  m_expiry;
+};
+
+// Host names are resolved on a helper thread and the results are cached. A
+// cached address is still handed out after it expires while a fresh lookup
+// runs in the background, so callers on the voice path never wait on DNS.
+class CResolver : public CThread {
+public:
+	static void start();
+	static void stop();
+
+	// Never blocks, returns false if there is no address for the host yet
+	static bool lookup(const std::string& host, in_addr& address);
+
+	// Waits up to timeout ms for the helper thread, for use off the voice path
+	static in_addr resolve(const std::string& host, unsigned int timeout = 5000U);
+
+	virtual void entry();
+
+private:
+	CResolver();
+
+	std::map<std::string, CResolverEntry> m_entries;
+	std::deque<std::string>               m_requests;
+	CMutex                                m_mutex;
+	std::atomic<bool>                     m_stop;
+
+	bool find(const std::string& host, in_addr& address, bool& pending);
+
+	static CResolver* s_resolver;
+};
+
+#endif
@@ -25,6 +25,17 @@
 #include <cassert>
 #include <cstring>
 
+// What addData() does when the new data does not fit
+enum RB_OVERFLOW {
+	RBO_CLEAR,			// Throw away everything queued
+	RBO_DROP_OLDEST,	// Throw away whole frames from the head until it fits
+	RBO_DROP_NEWEST,	// Throw away the new data
+	RBO_BLOCK			// Wait for the consumer, only for buffers shared between threads
+};
+
+// Frame length for buffers whose frames start with a one element payload length
+const unsigned int RB_LENGTH_PREFIXED = 0U;
+
 template<class T> class CRingBuffer {
 public:
 	CRingBuffer(unsigned int length, const char* name) :
@@ -32,7 +43,10 @@ public:
 	m_name(name),
 	m_buffer(NULL),
 	m_iPtr(0U),
-	m_oPtr(0U)
+	m_oPtr(0U),
+	m_overflow(RBO_DROP_NEWEST),
+	m_frameLength(1U),
+	m_dropped(0U)
 	{
 		assert(length > 0U);
 		assert(name != NULL);
@@ -47,11 +61,52 @@ public:
 		delete[] m_buffer;
 	}
 
+	// Frames must be added with a single call for the policies to keep them whole
+	void setOverflow(RB_OVERFLOW overflow, unsigned int frameLength)
+	{
+		assert(overflow != RBO_BLOCK);
+
+		m_overflow    = overflow;
+		m_frameLength = frameLength;
+	}
+
+	unsigned int getDropped() const
+	{
+		return m_dropped;
+	}
+
 	bool addData(const T* buffer, unsigned int nSamples)
 	{
+		if (nSamples >= freeSpace() && m_overflow == RBO_DROP_OLDEST) {
+			unsigned int dropped = 0U;
+			while (nSamples >= freeSpace() && hasData()) {
+				unsigned int length = m_frameLength;
+				if (length == RB_LENGTH_PREFIXED)
+					length = 1U + (unsigned int)m_buffer[m_oPtr];
+
+				if (length > dataSize())
+					length = dataSize();
+
+				m_oPtr = (m_oPtr + length) % m_length;
+				dropped++;
+			}
+
+			m_dropped += dropped;
+
+			if (nSamples < freeSpace())
+				LogWarning("%s buffer overflow, dropped the %u oldest frame(s), %u in total", m_name, dropped, m_dropped);
+		}
+
 		if (nSamples >= freeSpace()) {
-			LogError("%s buffer overflow, clearing the buffer. (%u >= %u)", m_name, nSamples, freeSpace());
-			clear();
+			m_dropped++;
+
+			if (m_overflow == RBO_CLEAR) {
+				LogError("%s buffer overflow, clearing the buffer. (%u >= %u)", m_name, nSamples, freeSpace());
+				clear();
+			} else {
+				LogError("%s buffer overflow, dropping the new data. (%u >= %u), %u dropped in total", m_name, nSamples, freeSpace(), m_dropped);
+			}
+
 			return false;
 		}
 
@@ -149,6 +204,9 @@ private:
 	T*           m_buffer;
 	unsigned int m_iPtr;
 	unsigned int m_oPtr;
+	RB_OVERFLOW  m_overflow;
+	unsigned int m_frameLength;
+	unsigned int m_dropped;
 };
 
 #endif
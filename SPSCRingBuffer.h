@@ -0,0 +1,202 @@
+/*
+ *   Copyright (C) 2018 by Andy Uribe CA6JAU
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#ifndef SPSCRingBuffer_H
+#define SPSCRingBuffer_H
+
+#include "RingBuffer.h"
+#include "Thread.h"
+#include "Log.h"
+
+#include <cstdio>
+#include <cassert>
+#include <cstring>
+#include <atomic>
+#include <type_traits>
+
+// Indices written by different threads are kept this far apart so that the
+// producer and the consumer never contend for the same cache line
+const unsigned int RING_CACHE_LINE = 64U;
+
+// The storage is sized to a power of two so that wrapping is a mask
+inline unsigned int ringBufferLength(unsigned int length)
+{
+	assert(length > 0U && length <= 0x80000000U);
+
+	unsigned int n = 1U;
+	while (n < length)
+		n <<= 1;
+
+	return n;
+}
+
+// A ring buffer that may be written by exactly one thread and read by exactly
+// one other thread without locking. Only the consumer may call getData(),
+// peek() and clear(), only the producer may call addData(). The pointers are
+// free running, so every slot is usable and the fill level is iPtr - oPtr.
+template<class T> class CSPSCRingBuffer {
+	static_assert(std::is_trivially_copyable<T>::value, "CSPSCRingBuffer moves its elements with memcpy");
+
+public:
+	CSPSCRingBuffer(unsigned int length, const char* name) :
+	m_length(ringBufferLength(length)),
+	m_mask(m_length - 1U),
+	m_name(name),
+	m_buffer(NULL),
+	m_overflow(RBO_DROP_NEWEST),
+	m_dropped(0U),
+	m_iPtr(0U),
+	m_oPtr(0U)
+	{
+		assert(length > 0U);
+		assert(name != NULL);
+
+		m_buffer = new T[m_length];
+
+		::memset(m_buffer, 0x00, m_length * sizeof(T));
+	}
+
+	~CSPSCRingBuffer()
+	{
+		delete[] m_buffer;
+	}
+
+	// Only the producer can act on an overflow, so the choice is between
+	// dropping the new data and waiting for the consumer to make room
+	void setOverflow(RB_OVERFLOW overflow)
+	{
+		assert(overflow == RBO_DROP_NEWEST || overflow == RBO_BLOCK);
+
+		m_overflow = overflow;
+	}
+
+	unsigned int getDropped() const
+	{
+		return m_dropped.load(std::memory_order_relaxed);
+	}
+
+	bool addData(const T* buffer, unsigned int nSamples)
+	{
+		assert(nSamples <= m_length);
+
+		unsigned int iPtr = m_iPtr.load(std::memory_order_relaxed);
+		unsigned int oPtr = m_oPtr.load(std::memory_order_acquire);
+
+		while (m_overflow == RBO_BLOCK && nSamples > m_length - (iPtr - oPtr)) {
+			CThread::sleep(1U);
+			oPtr = m_oPtr.load(std::memory_order_acquire);
+		}
+
+		if (nSamples > m_length - (iPtr - oPtr)) {
+			unsigned int dropped = m_dropped.fetch_add(1U, std::memory_order_relaxed) + 1U;
+			LogError("%s buffer overflow, dropping the new data. (%u > %u), %u dropped in total", m_name, nSamples, m_length - (iPtr - oPtr), dropped);
+			return false;
+		}
+
+		unsigned int pos   = iPtr & m_mask;
+		unsigned int first = m_length - pos;
+		if (first > nSamples)
+			first = nSamples;
+
+		::memcpy(m_buffer + pos, buffer, first * sizeof(T));
+		::memcpy(m_buffer, buffer + first, (nSamples - first) * sizeof(T));
+
+		m_iPtr.store(iPtr + nSamples, std::memory_order_release);
+
+		return true;
+	}
+
+	bool getData(T* buffer, unsigned int nSamples)
+	{
+		if (!peek(buffer, nSamples))
+			return false;
+
+		m_oPtr.store(m_oPtr.load(std::memory_order_relaxed) + nSamples, std::memory_order_release);
+
+		return true;
+	}
+
+	bool peek(T* buffer, unsigned int nSamples)
+	{
+		unsigned int oPtr = m_oPtr.load(std::memory_order_relaxed);
+		unsigned int iPtr = m_iPtr.load(std::memory_order_acquire);
+
+		if (iPtr - oPtr < nSamples) {
+			LogError("**** Underflow in %s ring buffer, %u < %u", m_name, iPtr - oPtr, nSamples);
+			return false;
+		}
+
+		unsigned int pos   = oPtr & m_mask;
+		unsigned int first = m_length - pos;
+		if (first > nSamples)
+			first = nSamples;
+
+		::memcpy(buffer, m_buffer + pos, first * sizeof(T));
+		::memcpy(buffer + first, m_buffer, (nSamples - first) * sizeof(T));
+
+		return true;
+	}
+
+	void clear()
+	{
+		m_oPtr.store(m_iPtr.load(std::memory_order_acquire), std::memory_order_release);
+	}
+
+	unsigned int freeSpace() const
+	{
+		return m_length - dataSize();
+	}
+
+	unsigned int dataSize() const
+	{
+		unsigned int oPtr = m_oPtr.load(std::memory_order_acquire);
+		unsigned int iPtr = m_iPtr.load(std::memory_order_acquire);
+
+		return iPtr - oPtr;
+	}
+
+	bool hasSpace(unsigned int length) const
+	{
+		return freeSpace() >= length;
+	}
+
+	bool hasData() const
+	{
+		return m_oPtr.load(std::memory_order_acquire) != m_iPtr.load(std::memory_order_acquire);
+	}
+
+	bool isEmpty() const
+	{
+		return m_oPtr.load(std::memory_order_acquire) == m_iPtr.load(std::memory_order_acquire);
+	}
+
+private:
+	unsigned int              m_length;
+	unsigned int              m_mask;
+	const char*               m_name;
+	T*                        m_buffer;
+	RB_OVERFLOW               m_overflow;
+	std::atomic<unsigned int> m_dropped;
+	char                      m_pad1[RING_CACHE_LINE];
+	std::atomic<unsigned int> m_iPtr;
+	char                      m_pad2[RING_CACHE_LINE - sizeof(std::atomic<unsigned int>)];
+	std::atomic<unsigned int> m_oPtr;
+	char                      m_pad3[RING_CACHE_LINE - sizeof(std::atomic<unsigned int>)];
+};
+
+#endif
@@ -17,7 +17,7 @@
  */
 
 #include "TCPSocket.h"
-#include "UDPSocket.h"
+#include "Resolver.h"
 #include "Log.h"
 
 #include <cstdio>
@@ -30,10 +30,16 @@ typedef int ssize_t;
 #include <cerrno>
 #endif
 
+// Also the longest line readLine() returns whole
+const unsigned int TCP_BUFFER_LENGTH = 4096U;
+
 CTCPSocket::CTCPSocket(const std::string& address, unsigned int port) :
 m_address(address),
 m_port(port),
-m_fd(-1)
+m_fd(-1),
+m_buffer(NULL),
+m_bufferPos(0U),
+m_bufferLen(0U)
 {
 	assert(!address.empty());
 	assert(port > 0U);
@@ -44,10 +50,14 @@ m_fd(-1)
 	if (wsaRet != 0)
 		LogError("Error from WSAStartup");
 #endif
+
+	m_buffer = new unsigned char[TCP_BUFFER_LENGTH];
 }
 
 CTCPSocket::~CTCPSocket()
 {
+	delete[] m_buffer;
+
 #if defined(_WIN32) || defined(_WIN64)
 	::WSACleanup();
 #endif
@@ -75,7 +85,7 @@ bool CTCPSocket::open()
 	::memset(&addr, 0x00, sizeof(struct sockaddr_in));
 	addr.sin_family = AF_INET;
 	addr.sin_port   = htons(m_port);
-	addr.sin_addr   = CUDPSocket::lookup(m_address);
+	addr.sin_addr   = CResolver::resolve(m_address);
 
 	if (addr.sin_addr.s_addr == INADDR_NONE) {
 		close();
@@ -112,6 +122,23 @@ int CTCPSocket::read(unsigned char* buffer, unsigned int length, unsigned int se
 	assert(length > 0U);
 	assert(m_fd != -1);
 
+	// Whatever readLine() has read beyond its last line comes first
+	if (m_bufferPos < m_bufferLen) {
+		unsigned int len = m_bufferLen - m_bufferPos;
+		if (len > length)
+			len = length;
+
+		::memcpy(buffer, m_buffer + m_bufferPos, len);
+		m_bufferPos += len;
+
+		return int(len);
+	}
+
+	return receive(buffer, length, secs, msecs);
+}
+
+int CTCPSocket::receive(unsigned char* buffer, unsigned int length, unsigned int secs, unsigned int msecs)
+{
 	// Check that the recv() won't block
 	fd_set readFds;
 	FD_ZERO(&readFds);
@@ -159,28 +186,41 @@ int CTCPSocket::read(unsigned char* buffer, unsigned int length, unsigned int se
 	return len;
 }
 
-int CTCPSocket::readLine(std::string& line, unsigned int secs)
+// Lines are split out of whole blocks read into the buffer, and the rest of
+// a block is kept for the next call. A line that does not fit the buffer is
+// returned in pieces. Returns the length of the line, including the newline,
+// 0 on a timeout, leaving any partial line buffered, or less than 0 on an error.
+int CTCPSocket::readLine(std::string& line, unsigned int secs, unsigned int msecs)
 {
-	// Maybe there is a better way to do this like reading blocks, pushing them for later calls
-	// Nevermind, we'll read one char at a time for the time being.
-	int resultCode;
-	int len = 0;
+	assert(m_fd != -1);
 
 	line.clear();
 
-	char c[2U];
-	c[1U] = 0x00U;
+	for (;;) {
+		unsigned int available = m_bufferLen - m_bufferPos;
 
-	do
-	{
-		resultCode = read((unsigned char*)c, 1U, secs);
-		if (resultCode == 1){
-			line.append(c);
-			len++;
+		unsigned char* end = (unsigned char*)::memchr(m_buffer + m_bufferPos, '\n', available);
+		if (end != NULL || available == TCP_BUFFER_LENGTH) {
+			unsigned int len = end != NULL ? (unsigned int)(end - (m_buffer + m_bufferPos)) + 1U : available;
+
+			line.assign((char*)m_buffer + m_bufferPos, len);
+			m_bufferPos += len;
+
+			return int(len);
+		}
+
+		if (m_bufferPos > 0U) {
+			::memmove(m_buffer, m_buffer + m_bufferPos, available);
+			m_bufferPos = 0U;
+			m_bufferLen = available;
 		}
-	} while (c[0U] != '\n' && resultCode == 1);
 
-	return resultCode <= 0 ? resultCode : len;
+		int ret = receive(m_buffer + m_bufferLen, TCP_BUFFER_LENGTH - m_bufferLen, secs, msecs);
+		if (ret <= 0)
+			return ret;
+
+		m_bufferLen += (unsigned int)ret;
+	}
 }
 
 bool CTCPSocket::write(const unsigned char* buffer, unsigned int length)
@@ -208,15 +248,46 @@ bool CTCPSocket::writeLine(const std::string& line)
 	if (lineCopy.length() > 0 && lineCopy.at(lineCopy.length() - 1) != '\n')
 		lineCopy.append("\n");
 	
-	//stupidly write one char after the other
-	size_t len = lineCopy.length();
-	bool result = true;
-	for (size_t i = 0U; i < len && result; i++){
-		unsigned char c = lineCopy.at(i);
-		result = write(&c , 1);
+	return write((const unsigned char*)lineCopy.c_str(), (unsigned int)lineCopy.length());
+}
+
+// Writes what the socket takes without waiting for room, returns the number
+// of bytes written, which may be 0, or -1 on an error
+int CTCPSocket::writeNoWait(const unsigned char* buffer, unsigned int length)
+{
+	assert(buffer != NULL);
+	assert(length > 0U);
+	assert(m_fd != -1);
+
+#if defined(_WIN32) || defined(_WIN64)
+	u_long nonBlocking = 1UL;
+	::ioctlsocket(m_fd, FIONBIO, &nonBlocking);
+
+	int ret = ::send(m_fd, (char *)buffer, length, 0);
+
+	nonBlocking = 0UL;
+	::ioctlsocket(m_fd, FIONBIO, &nonBlocking);
+
+	if (ret < 0 && ::WSAGetLastError() == WSAEWOULDBLOCK)
+		return 0;
+
+	if (ret < 0) {
+		LogError("Error returned from send, err=%d", ::GetLastError());
+		return -1;
 	}
+#else
+	ssize_t ret = ::send(m_fd, (char *)buffer, length, MSG_DONTWAIT);
+
+	if (ret < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+		return 0;
+
+	if (ret < 0) {
+		LogError("Error returned from send, err=%d", errno);
+		return -1;
+	}
+#endif
 
-	return result;
+	return int(ret);
 }
 
 void CTCPSocket::close()
@@ -229,4 +300,7 @@ void CTCPSocket::close()
 #endif
 		m_fd = -1;
 	}
+
+	m_bufferPos = 0U;
+	m_bufferLen = 0U;
 }
@@ -43,9 +43,10 @@ public:
 	bool open();
 
 	int  read(unsigned char* buffer, unsigned int length, unsigned int secs, unsigned int msecs = 0U);
-	int readLine(std::string& line, unsigned int secs);
+	int readLine(std::string& line, unsigned int secs, unsigned int msecs = 0U);
 	bool write(const unsigned char* buffer, unsigned int length);
 	bool writeLine(const std::string& line);
+	int  writeNoWait(const unsigned char* buffer, unsigned int length);
 
 	void close();
 
@@ -53,6 +54,11 @@ private:
 	std::string    m_address;
 	unsigned short m_port;
 	int            m_fd;
+	unsigned char* m_buffer;
+	unsigned int   m_bufferPos;
+	unsigned int   m_bufferLen;
+
+	int  receive(unsigned char* buffer, unsigned int length, unsigned int secs, unsigned int msecs);
 };
 
 #endif
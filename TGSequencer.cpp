@@ -0,0 +1,85 @@
+/*
+*   Copyright (C) 2018 by Andy Uribe CA6JAU
+*
+*   This program is free software; you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation; either version 2 of the License, or
+*   (at your option) any later version.
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program; if not, write to the Free Software
+*   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+*/
+
+#include "TGSequencer.h"
+#include "Log.h"
+
+#include <cstdio>
+#include <cassert>
+
+// The delays are in ms, a delay of 0 takes the step on the next clock
+CTGSequencer::CTGSequencer(unsigned int replyDelay, unsigned int pttDelay, unsigned int unlinkTimeout) :
+m_replyTimer(1000U, 0U, replyDelay > 0U ? replyDelay : 1U),
+m_pttTimer(1000U, 0U, pttDelay > 0U ? pttDelay : 1U),
+m_unlinkTimer(1000U, 0U, unlinkTimeout > 0U ? unlinkTimeout : 1U)
+{
+}
+
+CTGSequencer::~CTGSequencer()
+{
+}
+
+// Called with the unlink already sent to the master, if one is needed
+void CTGSequencer::start(bool unlink)
+{
+	m_replyTimer.start();
+
+	if (unlink) {
+		m_unlinkTimer.start();
+		m_pttTimer.stop();
+	} else {
+		m_unlinkTimer.stop();
+		m_pttTimer.start();
+	}
+}
+
+// The master has ended the unlink transmission
+void CTGSequencer::unlinked()
+{
+	if (!m_unlinkTimer.isRunning())
+		return;
+
+	m_unlinkTimer.stop();
+	m_pttTimer.start();
+}
+
+// Returns each step once when it is due, the reply before the PTT
+TG_STATUS CTGSequencer::clock(unsigned int ms)
+{
+	m_replyTimer.clock(ms);
+	m_pttTimer.clock(ms);
+	m_unlinkTimer.clock(ms);
+
+	if (m_unlinkTimer.isRunning() && m_unlinkTimer.hasExpired()) {
+		LogMessage("No unlink confirmation from the master, changing TG anyway");
+		m_unlinkTimer.stop();
+		m_pttTimer.start();
+	}
+
+	if (m_replyTimer.isRunning() && m_replyTimer.hasExpired()) {
+		m_replyTimer.stop();
+		return SEND_REPLY;
+	}
+
+	if (m_pttTimer.isRunning() && m_pttTimer.hasExpired() && !m_replyTimer.isRunning()) {
+		m_pttTimer.stop();
+		return SEND_PTT;
+	}
+
+	return NONE;
+}
@@ -0,0 +1,53 @@
+/*
+*   Copyright (C) 2018 by Andy Uribe CA6JAU
+*
+*   This program is free software; you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation; either version 2 of the License, or
+*   (at your option) any later version.
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program; if not, write to the Free Software
+*   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+*/
+
+#if !defined(TGSequencer_H)
+#define	TGSequencer_H
+
+#include "Timer.h"
+
+enum TG_STATUS {
+	NONE,
+	SEND_REPLY,
+	SEND_PTT
+};
+
+// Orders the steps of a talkgroup change. The Wires-X reply goes back to the
+// radio a short gap after the request, while the unlink sent to the master is
+// still being confirmed. The PTT on the new talkgroup follows a short gap
+// after the master confirms the unlink, or after the request when no unlink
+// is needed. An unlink that is never confirmed delays the PTT only up to
+// the unlink timeout.
+class CTGSequencer {
+public:
+	CTGSequencer(unsigned int replyDelay, unsigned int pttDelay, unsigned int unlinkTimeout);
+	~CTGSequencer();
+
+	void start(bool unlink);
+
+	void unlinked();
+
+	TG_STATUS clock(unsigned int ms);
+
+private:
+	CTimer m_replyTimer;
+	CTimer m_pttTimer;
+	CTimer m_unlinkTimer;
+};
+
+#endif
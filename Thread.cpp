@@ -17,11 +17,39 @@
  */
 
 #include "Thread.h"
+#include "Log.h"
+
+unsigned int CThread::s_stackSize = 0U;
+
+void CThread::setStackSize(unsigned int size)
+{
+  s_stackSize = size;
+}
+
+void CThread::setName(const std::string& name)
+{
+  m_name = name;
+}
+
+void CThread::setRealTime(THREAD_POLICY policy, unsigned int priority)
+{
+  m_policy   = policy;
+  m_priority = priority;
+}
+
+void CThread::setAffinity(const std::vector<unsigned int>& cpus)
+{
+  m_cpus = cpus;
+}
 
 #if defined(_WIN32) || defined(_WIN64)
 
 CThread::CThread() :
-m_handle()
+m_handle(),
+m_name(),
+m_policy(TP_NORMAL),
+m_priority(0U),
+m_cpus()
 {
 }
 
@@ -31,7 +59,7 @@ CThread::~CThread()
 
 bool CThread::run()
 {
-  m_handle = ::CreateThread(NULL, 0, &helper, this, 0, NULL);
+  m_handle = ::CreateThread(NULL, s_stackSize, &helper, this, 0, NULL);
 
   return m_handle != NULL;
 }
@@ -45,10 +73,26 @@ void CThread::wait()
 }
 
 
+// Windows has no real time policies, a real time thread gets the highest priority
+void CThread::setup()
+{
+  if (m_policy != TP_NORMAL && m_priority > 0U)
+    ::SetThreadPriority(::GetCurrentThread(), THREAD_PRIORITY_TIME_CRITICAL);
+
+  if (!m_cpus.empty()) {
+    DWORD_PTR mask = 0U;
+    for (std::vector<unsigned int>::const_iterator it = m_cpus.begin(); it != m_cpus.end(); ++it)
+      mask |= DWORD_PTR(1) << *it;
+
+    ::SetThreadAffinityMask(::GetCurrentThread(), mask);
+  }
+}
+
 DWORD CThread::helper(LPVOID arg)
 {
   CThread* p = (CThread*)arg;
 
+  p->setup();
   p->entry();
 
   return 0UL;
@@ -62,9 +106,16 @@ void CThread::sleep(unsigned int ms)
 #else
 
 #include <unistd.h>
+#include <sched.h>
+#include <cstring>
+#include <cerrno>
 
 CThread::CThread() :
-m_thread()
+m_thread(),
+m_name(),
+m_policy(TP_NORMAL),
+m_priority(0U),
+m_cpus()
 {
 }
 
@@ -74,7 +125,18 @@ CThread::~CThread()
 
 bool CThread::run()
 {
-  return ::pthread_create(&m_thread, NULL, helper, this) == 0;
+  if (s_stackSize == 0U)
+    return ::pthread_create(&m_thread, NULL, helper, this) == 0;
+
+  pthread_attr_t attr;
+  ::pthread_attr_init(&attr);
+  ::pthread_attr_setstacksize(&attr, s_stackSize);
+
+  int ret = ::pthread_create(&m_thread, &attr, helper, this);
+
+  ::pthread_attr_destroy(&attr);
+
+  return ret == 0;
 }
 
 
@@ -84,10 +146,41 @@ void CThread::wait()
 }
 
 
+// Runs on the new thread, a setting that cannot be applied is only logged
+void CThread::setup()
+{
+#if defined(__linux__)
+  if (!m_name.empty())
+    ::pthread_setname_np(::pthread_self(), m_name.substr(0U, 15U).c_str());
+
+  if (!m_cpus.empty()) {
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    for (std::vector<unsigned int>::const_iterator it = m_cpus.begin(); it != m_cpus.end(); ++it)
+      CPU_SET(*it, &cpus);
+
+    int ret = ::pthread_setaffinity_np(::pthread_self(), sizeof(cpu_set_t), &cpus);
+    if (ret != 0)
+      LogWarning("Cannot pin the %s thread to its CPUs, err=%d", m_name.c_str(), ret);
+  }
+#endif
+
+  if (m_policy != TP_NORMAL && m_priority > 0U) {
+    sched_param param;
+    ::memset(&param, 0x00U, sizeof(sched_param));
+    param.sched_priority = int(m_priority);
+
+    int ret = ::pthread_setschedparam(::pthread_self(), m_policy == TP_FIFO ? SCHED_FIFO : SCHED_RR, &param);
+    if (ret != 0)
+      LogWarning("Cannot give the %s thread real time priority %u, err=%d", m_name.c_str(), m_priority, ret);
+  }
+}
+
 void* CThread::helper(void* arg)
 {
   CThread* p = (CThread*)arg;
 
+  p->setup();
   p->entry();
 
   return NULL;
@@ -25,12 +25,26 @@
 #include <pthread.h>
 #endif
 
+#include <string>
+#include <vector>
+
+enum THREAD_POLICY {
+  TP_NORMAL,
+  TP_FIFO,
+  TP_RR
+};
+
 class CThread
 {
 public:
   CThread();
   virtual ~CThread();
 
+  // These take effect when the thread starts, so they are set before run()
+  void setName(const std::string& name);
+  void setRealTime(THREAD_POLICY policy, unsigned int priority);
+  void setAffinity(const std::vector<unsigned int>& cpus);
+
   virtual bool run();
 
   virtual void entry() = 0;
@@ -39,12 +53,23 @@ public:
 
   static void sleep(unsigned int ms);
 
+  // For the threads started afterwards, 0 for the system default
+  static void setStackSize(unsigned int size);
+
 private:
 #if defined(_WIN32) || defined(_WIN64)
   HANDLE    m_handle;
 #else
   pthread_t m_thread;
 #endif
+  std::string               m_name;
+  THREAD_POLICY             m_policy;
+  unsigned int              m_priority;
+  std::vector<unsigned int> m_cpus;
+
+  static unsigned int s_stackSize;
+
+  void setup();
 
 #if defined(_WIN32) || defined(_WIN64)
   static DWORD __stdcall helper(LPVOID arg);
@@ -24,6 +24,7 @@
 #if !defined(_WIN32) && !defined(_WIN64)
 #include <cerrno>
 #include <cstring>
+#include <sys/uio.h>
 #endif
 
 
@@ -252,6 +253,76 @@ bool CUDPSocket::write(const unsigned char* buffer, unsigned int length, const i
 	return true;
 }
 
+// The same datagram to several destinations, in as few system calls as the
+// platform allows. Returns the number of destinations it was sent to.
+unsigned int CUDPSocket::write(const unsigned char* buffer, unsigned int length, const in_addr* addresses, const unsigned int* ports, unsigned int count)
+{
+	assert(buffer != NULL);
+	assert(length > 0U);
+	assert(addresses != NULL);
+	assert(ports != NULL);
+
+#if defined(__linux__)
+	const unsigned int BATCH_SIZE = 32U;
+
+	sockaddr_in addrs[BATCH_SIZE];
+	mmsghdr msgs[BATCH_SIZE];
+
+	// Every message points at the caller's buffer, nothing is copied
+	iovec iov;
+	iov.iov_base = (void*)buffer;
+	iov.iov_len  = length;
+
+	unsigned int sent = 0U;
+
+	for (unsigned int start = 0U; start < count; start += BATCH_SIZE) {
+		unsigned int n = count - start;
+		if (n > BATCH_SIZE)
+			n = BATCH_SIZE;
+
+		::memset(msgs, 0x00, n * sizeof(mmsghdr));
+
+		for (unsigned int i = 0U; i < n; i++) {
+			::memset(addrs + i, 0x00, sizeof(sockaddr_in));
+			addrs[i].sin_family = AF_INET;
+			addrs[i].sin_addr   = addresses[start + i];
+			addrs[i].sin_port   = htons(ports[start + i]);
+
+			msgs[i].msg_hdr.msg_name    = addrs + i;
+			msgs[i].msg_hdr.msg_namelen = sizeof(sockaddr_in);
+			msgs[i].msg_hdr.msg_iov     = &iov;
+			msgs[i].msg_hdr.msg_iovlen  = 1U;
+		}
+
+		unsigned int done = 0U;
+		while (done < n) {
+			int ret = ::sendmmsg(m_fd, msgs + done, n - done, 0);
+
+			// Only the first message has failed, the destinations after it still get theirs
+			if (ret < 0) {
+				LogError("Error returned from sendmmsg, err: %d", errno);
+				done++;
+				continue;
+			}
+
+			done += ret;
+			sent += ret;
+		}
+	}
+
+	return sent;
+#else
+	unsigned int sent = 0U;
+
+	for (unsigned int i = 0U; i < count; i++) {
+		if (write(buffer, length, addresses[i], ports[i]))
+			sent++;
+	}
+
+	return sent;
+#endif
+}
+
 void CUDPSocket::close()
 {
 #if defined(_WIN32) || defined(_WIN64)
@@ -44,6 +44,7 @@ public:
 
 	int  read(unsigned char* buffer, unsigned int length, in_addr& address, unsigned int& port);
 	bool write(const unsigned char* buffer, unsigned int length, const in_addr& address, unsigned int port);
+	unsigned int write(const unsigned char* buffer, unsigned int length, const in_addr* addresses, const unsigned int* ports, unsigned int count);
 
 	void close();
 
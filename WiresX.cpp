@@ -66,7 +66,9 @@ m_csd2(NULL),
 m_csd3(NULL),
 m_status(WXSI_NONE),
 m_start(0U),
-m_search()
+m_search(),
+m_currTGList(),
+m_newTGList(NULL)
 {
 	assert(network != NULL);
 
@@ -86,51 +88,92 @@ m_search()
 	m_csd2   = new unsigned char[20U];
 	m_csd3   = new unsigned char[20U];
 
-	// Load file with TG List
+	readTGList(tgfile, m_currTGList);
+}
+
+CWiresX::~CWiresX()
+{
+	deleteTGList(m_currTGList);
+
+	std::vector<CTGReg*>* list = m_newTGList.exchange(NULL);
+	if (list != NULL) {
+		deleteTGList(*list);
+		delete list;
+	}
+
+	delete[] m_csd3;
+	delete[] m_csd2;
+	delete[] m_csd1;
+	delete[] m_header;
+	delete[] m_command;
+}
+
+bool CWiresX::readTGList(const std::string& tgfile, std::vector<CTGReg*>& list)
+{
 	FILE* fp = ::fopen(tgfile.c_str(), "rt");
-	if (fp != NULL) {
-		char buffer[100U];
-		while (::fgets(buffer, 100U, fp) != NULL) {
-			if (buffer[0U] == '#')
-				continue;
+	if (fp == NULL)
+		return false;
 
-			char* p1 = ::strtok(buffer, ";\r\n");
-			char* p2 = ::strtok(NULL, ";\r\n");
-			char* p3 = ::strtok(NULL, ";\r\n");
-			char* p4 = ::strtok(NULL, "\r\n");
+	char buffer[100U];
+	while (::fgets(buffer, 100U, fp) != NULL) {
+		if (buffer[0U] == '#')
+			continue;
 
-			if (p1 != NULL && p2 != NULL && p3 != NULL && p4 != NULL ) {
-				CTGReg* tgreg = new CTGReg;
+		char* p1 = ::strtok(buffer, ";\r\n");
+		char* p2 = ::strtok(NULL, ";\r\n");
+		char* p3 = ::strtok(NULL, ";\r\n");
+		char* p4 = ::strtok(NULL, "\r\n");
 
-				std::string id_tmp = std::string(p1);
+		if (p1 != NULL && p2 != NULL && p3 != NULL && p4 != NULL ) {
+			CTGReg* tgreg = new CTGReg;
 
-				int n_zero = 7 - id_tmp.length();
-				if (n_zero < 0)
-					n_zero = 0;
+			std::string id_tmp = std::string(p1);
 
-				tgreg->m_id = std::string(n_zero, '0') + id_tmp;
-				tgreg->m_opt = std::string(p2);
-				tgreg->m_name = std::string(p3);
-				tgreg->m_desc = std::string(p4);
+			int n_zero = 7 - id_tmp.length();
+			if (n_zero < 0)
+				n_zero = 0;
 
-				tgreg->m_name.resize(16U, ' ');
-				tgreg->m_desc.resize(14U, ' ');
+			tgreg->m_id = std::string(n_zero, '0') + id_tmp;
+			tgreg->m_opt = std::string(p2);
+			tgreg->m_name = std::string(p3);
+			tgreg->m_desc = std::string(p4);
 
-				m_currTGList.push_back(tgreg);
-			}
+			tgreg->m_name.resize(16U, ' ');
+			tgreg->m_desc.resize(14U, ' ');
+
+			list.push_back(tgreg);
 		}
+	}
 
-		::fclose(fp);
+	::fclose(fp);
+
+	return true;
+}
+
+// Read here on the file watcher's thread, the list is swapped in by clock()
+void CWiresX::fileChanged(const std::string& fileName)
+{
+	std::vector<CTGReg*>* list = new std::vector<CTGReg*>;
+
+	if (!readTGList(fileName, *list)) {
+		LogWarning("Cannot read the TGList file %s, keeping the old list", fileName.c_str());
+		delete list;
+		return;
 	}
+
+	list = m_newTGList.exchange(list);
+	if (list != NULL)
+		deleteTGList(*list);
+
+	delete list;
 }
 
-CWiresX::~CWiresX()
+void CWiresX::deleteTGList(std::vector<CTGReg*>& list)
 {
-	delete[] m_csd3;
-	delete[] m_csd2;
-	delete[] m_csd1;
-	delete[] m_header;
-	delete[] m_command;
+	for (std::vector<CTGReg*>::iterator it = list.begin(); it != list.end(); ++it)
+		delete *it;
+
+	list.clear();
 }
 
 void CWiresX::setInfo(const std::string& name, unsigned int txFrequency, unsigned int rxFrequency, int dstID)
@@ -359,6 +402,17 @@ void CWiresX::processDisconnect(const unsigned char* source)
 
 void CWiresX::clock(unsigned int ms)
 {
+	std::vector<CTGReg*>* list = m_newTGList.exchange(NULL);
+	if (list != NULL) {
+		m_currTGList.swap(*list);
+		m_TGSearch.clear();
+		deleteTGList(*list);
+		delete list;
+
+		// A list request part way through carries on from the start of the new list
+		m_start = 0U;
+	}
+
 	m_timer.clock(ms);
 	if (m_timer.isRunning() && m_timer.hasExpired()) {
 		switch (m_status) {
@@ -25,8 +25,10 @@
 #include "DMRNetwork.h"
 #include "Thread.h"
 #include "Timer.h"
+#include "FileWatcher.h"
 
 #include <vector>
+#include <atomic>
 #include <string>
 
 enum WX_STATUS {
@@ -63,7 +65,7 @@ public:
 	std::string  m_desc;
 };
 
-class CWiresX {
+class CWiresX : public CFileListener {
 public:
 	CWiresX(const std::string& callsign, const std::string& suffix, CYSFNetwork* network, std::string tgfile);
 	~CWiresX();
@@ -85,6 +87,8 @@ public:
 	void sendDisconnectReply();
 	void clock(unsigned int ms);
 
+	virtual void fileChanged(const std::string& fileName);
+
 private:
 	std::string          m_callsign;
 	std::string          m_node;
@@ -106,6 +110,7 @@ private:
 	unsigned int         m_start;
 	std::string          m_search;
 	std::vector<CTGReg*> m_currTGList;
+	std::atomic<std::vector<CTGReg*>*> m_newTGList;	// Read by the file watcher, not yet taken up
 	std::vector<CTGReg*> m_TGSearch;
 
 	WX_STATUS processConnect(const unsigned char* source, const unsigned char* data);
@@ -118,6 +123,9 @@ private:
 	void sendSearchNotFoundReply();
 	void createReply(const unsigned char* data, unsigned int length);
 	unsigned char calculateFT(unsigned int length, unsigned int offset) const;
+
+	static bool readTGList(const std::string& tgfile, std::vector<CTGReg*>& list);
+	static void deleteTGList(std::vector<CTGReg*>& list);
 };
 
 #endif
@@ -28,14 +28,19 @@
 #include <signal.h>
 #include <fcntl.h>
 #include <pwd.h>
+#include <sys/mman.h>
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+#include <sys/resource.h>
 #endif
 
 // DT1 and DT2, suggested by Manuel EA7EE
 const unsigned char dt1_temp[] = {0x31, 0x22, 0x62, 0x5F, 0x15, 0x00, 0x00, 0x00, 0x00, 0x00};
 const unsigned char dt2_temp[] = {0x00, 0x00, 0x00, 0x00, 0x6C, 0x20, 0x1C, 0x20, 0x03, 0x08};
 
-#define DMR_FRAME_PER       55U
-#define YSF_FRAME_PER       90U
+#define DMR_FRAME_PER       60U
+#define YSF_FRAME_PER       100U
 
 #define XLX_SLOT            2U
 #define XLX_COLOR_CODE      3U
@@ -53,8 +58,11 @@ const char* DEFAULT_INI_FILE = "/etc/YSF2DMR.ini";
 #include <cstring>
 #include <clocale>
 #include <cctype>
+#include <cassert>
+#include <cerrno>
 
 int end = 0;
+int reload = 0;
 
 #if !defined(_WIN32) && !defined(_WIN64)
 void sig_handler(int signo)
@@ -62,6 +70,8 @@ void sig_handler(int signo)
 	if (signo == SIGTERM) {
 		end = 1;
 		::fprintf(stdout, "Received SIGTERM\n");
+	} else if (signo == SIGHUP) {
+		reload = 1;
 	}
 }
 #endif
@@ -88,6 +98,10 @@ int main(int argc, char** argv)
 	// Capture SIGTERM to finish gracelessly
 	if (signal(SIGTERM, sig_handler) == SIG_ERR) 
 		::fprintf(stdout, "Can't catch SIGTERM\n");
+
+	// SIGHUP reads the .ini file again
+	if (signal(SIGHUP, sig_handler) == SIG_ERR)
+		::fprintf(stdout, "Can't catch SIGHUP\n");
 #endif
 
 	CYSF2DMR* gateway = new CYSF2DMR(std::string(iniFile));
@@ -102,22 +116,27 @@ int main(int argc, char** argv)
 CYSF2DMR::CYSF2DMR(const std::string& configFile) :
 m_callsign(),
 m_suffix(),
+m_configFile(configFile),
 m_conf(configFile),
 m_wiresX(NULL),
 m_dmrNetwork(NULL),
-m_dmrLastDT(0U),
+m_unlinkReceived(false),
 m_gps(NULL),
 m_dtmf(NULL),
 m_APRS(NULL),
-m_dmrFrames(0U),
+m_lastHeard(NULL),
+m_watcher(NULL),
 m_ysfFrames(0U),
-m_dmrinfo(false),
+m_lcCache(16U),
 m_idUnlink(4000U),
 m_flcoUnlink(FLCO_GROUP),
 m_enableWiresX(false)
 {
-	::memset(m_ysfFrame, 0U, 200U);
 	::memset(m_dmrFrame, 0U, 50U);
+
+	m_bridges[0U] = NULL;
+	m_bridges[1U] = NULL;
+	m_bridges[2U] = NULL;
 }
 
 CYSF2DMR::~CYSF2DMR()
@@ -148,6 +167,13 @@ int CYSF2DMR::run()
 	}
 
 #if !defined(_WIN32) && !defined(_WIN64)
+	// A relative name would no longer be found after the daemon changes directory
+	char* path = ::realpath(m_configFile.c_str(), NULL);
+	if (path != NULL) {
+		m_configFile = path;
+		::free(path);
+	}
+
 	bool m_daemon = m_conf.getDaemon();
 	if (m_daemon) {
 		// Create new process
@@ -174,6 +200,8 @@ int CYSF2DMR::run()
 		::close(STDOUT_FILENO);
 		::close(STDERR_FILENO);
 
+		prepareRealTime();
+
 		//If we are currently root...
 		if (getuid() == 0) {
 			struct passwd* user = ::getpwnam("mmdvm");
@@ -202,24 +230,40 @@ int CYSF2DMR::run()
 				return -1;
 			}
 		}
+	} else {
+		prepareRealTime();
 	}
 #endif
 
+	// Started after any fork, so that the thread belongs to the daemon
+	CResolver::start();
+
+	m_watcher = new CFileWatcher;
+	m_watcher->start();
+
 	m_callsign = m_conf.getCallsign();
 	m_suffix   = m_conf.getSuffix();
 
 	bool debug               = m_conf.getDMRNetworkDebug();
-	in_addr dstAddress       = CUDPSocket::lookup(m_conf.getDstAddress());
+	in_addr dstAddress       = CResolver::resolve(m_conf.getDstAddress());
 	unsigned int dstPort     = m_conf.getDstPort();
 	std::string localAddress = m_conf.getLocalAddress();
 	unsigned int localPort   = m_conf.getLocalPort();
 
 	std::string fileName    = m_conf.getDMRXLXFile();
-	m_xlxReflectors = new CReflectors(fileName, 60U);
+	m_xlxReflectors = new CReflectors(fileName);
 	m_xlxReflectors->load();
+	if (!fileName.empty())
+		m_watcher->add(fileName, m_xlxReflectors);
 
 	m_ysfNetwork = new CYSFNetwork(localAddress, localPort, m_callsign, debug);
-	m_ysfNetwork->setDestination(dstAddress, dstPort);
+
+	if (m_conf.getReflectorMode()) {
+		LogMessage("YSF reflector mode, clients time out after %us, at most %u clients", m_conf.getClientTimeout(), m_conf.getMaxClients());
+		m_ysfNetwork->setReflectorMode(m_conf.getClientTimeout(), m_conf.getMaxClients());
+	} else {
+		m_ysfNetwork->setDestination(dstAddress, dstPort);
+	}
 
 	ret = m_ysfNetwork->open();
 	if (!ret) {
@@ -234,24 +278,70 @@ int CYSF2DMR::run()
 		::LogFinalise();
 		return 1;
 	}
+
+	DMR_ARBITRATION arbitration = DMR_ARBITRATION(m_conf.getDMRNetworkArbitration());
+	unsigned int priorityTG     = m_conf.getDMRNetworkPriorityTG();
+	unsigned int hangTime       = m_conf.getDMRNetworkHangTime();
+
+	m_bridges[2U] = new CBridgeSlot(2U, m_ysfNetwork, m_colorcode, arbitration, priorityTG, hangTime);
+	m_bridges[2U]->m_fanOut.add(m_dmrNetwork, 0U, FLCO_GROUP);
+
+	ret = createFanOutNetworks();
+	if (!ret) {
+		::LogError("Cannot open the DMR fan out networks");
+		::LogFinalise();
+		return 1;
+	}
+
+	// A second YSF endpoint on TS1, sharing the DMR login
+	if (m_conf.getSlot1Enabled()) {
+		CYSFNetwork* network = new CYSFNetwork(m_conf.getSlot1LocalAddress(), m_conf.getSlot1LocalPort(), m_callsign, debug);
+		network->setDestination(CResolver::resolve(m_conf.getSlot1DstAddress()), m_conf.getSlot1DstPort());
+
+		ret = network->open();
+		if (!ret) {
+			::LogError("Cannot open the slot 1 YSF network port");
+			::LogFinalise();
+			return 1;
+		}
+
+		CBridgeSlot* bridge = new CBridgeSlot(1U, network, m_colorcode, arbitration, priorityTG, hangTime);
+		bridge->m_fanOut.add(m_dmrNetwork, 0U, FLCO_GROUP);
+		bridge->m_srcId = m_defsrcid;
+		bridge->m_dstId = m_conf.getSlot1DstId();
+		bridge->m_flco  = m_conf.getSlot1PC() ? FLCO_USER_USER : FLCO_GROUP;
+		m_bridges[1U] = bridge;
+
+		LogMessage("Slot 1 bridged to %s%u", bridge->m_flco == FLCO_GROUP ? "TG " : "", bridge->m_dstId);
+	}
 	
 	std::string lookupFile  = m_conf.getDMRIdLookupFile();
 	unsigned int reloadTime = m_conf.getDMRIdLookupTime();
 
-	m_lookup = new CDMRLookup(lookupFile, reloadTime);
+	m_lookup = new CDMRLookup(lookupFile);
 	m_lookup->read();
+	if (reloadTime > 0U)
+		m_watcher->add(lookupFile, m_lookup);
+
+	if (m_conf.getLastHeardEnabled()) {
+		m_lastHeard = new CLastHeard(m_conf.getLastHeardName());
+		if (!m_lastHeard->open()) {
+			delete m_lastHeard;
+			m_lastHeard = NULL;
+		}
+	}
 
 	if (m_dmrpc)
 		m_dmrflco = FLCO_USER_USER;
 	else
 		m_dmrflco = FLCO_GROUP;
 
-	CTimer networkWatchdog(100U, 0U, 1500U);
 	CTimer pollTimer(1000U, 5U);
 
 	// CWiresX Control Object
 	if (m_enableWiresX) {
 		m_wiresX = new CWiresX(m_callsign, m_suffix, m_ysfNetwork, m_TGList);
+		m_watcher->add(m_TGList, m_wiresX);
 		m_dtmf = new CDTMF;
 	}
 
@@ -265,37 +355,57 @@ int CYSF2DMR::run()
 
 	if (m_conf.getAPRSEnabled()) {
 		createGPS();
-		m_APRS = new CAPRSReader(m_conf.getAPRSAPIKey(), m_conf.getAPRSRefresh());
+		m_APRS = new CAPRSReader(m_conf.getAPRSAPIKey(), m_conf.getAPRSRefresh(), m_conf.getAPRSAPIServer(), m_conf.getAPRSAPIPort(), m_conf.getAPRSCacheFile(), m_conf.getAPRSCacheSize());
 	}
 	
-	CStopWatch TGChange;
 	CStopWatch stopWatch;
-	CStopWatch ysfWatch;
-	CStopWatch dmrWatch;
 	stopWatch.start();
-	ysfWatch.start();
-	dmrWatch.start();
 	pollTimer.start();
 
-	unsigned char ysf_cnt = 0;
-	unsigned char dmr_cnt = 0;
-
 	LogMessage("Starting YSF2DMR-%s", VERSION);
+	LogMessage("Using the %s Viterbi decoder", CYSFConvolution::getKernel());
 
 	bool enableUnlink = m_conf.getDMRNetworkEnableUnlink();
-	bool unlinkReceived = false;
 
-	TG_STATUS TG_connect_state = NONE;
-	unsigned char gps_buffer[20U];
+	CTGSequencer tgChange(m_conf.getDMRNetworkReplyDelay(), m_conf.getDMRNetworkPTTDelay(), m_conf.getDMRNetworkUnlinkTimeout());
 
 	unsigned int tglistOpt = 0; 
 
-	for (; end == 0;) {
-		unsigned char buffer[2000U];
+	// Each direction is transcoded and paced on its own thread, fed through
+	// lock-free queues, so that neither cadence depends on the other's load
+	CStageThread dmrIngress(this, &CYSF2DMR::dmrIngress);
+	CStageThread ysf2dmr(this, &CYSF2DMR::ysf2dmrStage, m_bridges[2U]);
+	CStageThread dmr2ysf(this, &CYSF2DMR::dmr2ysfStage, m_bridges[2U]);
+	CStageThread ysf2dmr1(this, &CYSF2DMR::ysf2dmrStage, m_bridges[1U]);
+	CStageThread dmr2ysf1(this, &CYSF2DMR::dmr2ysfStage, m_bridges[1U]);
+	dmrIngress.setName("dmr-ingress");
+	ysf2dmr.setName("ysf2dmr-ts2");
+	dmr2ysf.setName("dmr2ysf-ts2");
+	ysf2dmr1.setName("ysf2dmr-ts1");
+	dmr2ysf1.setName("dmr2ysf-ts1");
+
+	CThread* voiceThreads[] = {&dmrIngress, &ysf2dmr, &dmr2ysf, &ysf2dmr1, &dmr2ysf1};
+	for (unsigned int i = 0U; i < 5U; i++) {
+		voiceThreads[i]->setRealTime(m_conf.getTranscoderRoundRobin() ? TP_RR : TP_FIFO, m_conf.getTranscoderPriority());
+		voiceThreads[i]->setAffinity(m_conf.getTranscoderCPUs());
+	}
 
-		CDMRData tx_dmrdata;
+	dmrIngress.run();
+	ysf2dmr.run();
+	dmr2ysf.run();
+	if (m_bridges[1U] != NULL) {
+		ysf2dmr1.run();
+		dmr2ysf1.run();
+	}
+
+	for (; end == 0;) {
 		unsigned int ms = stopWatch.elapsed();
 
+		if (reload != 0) {
+			reload = 0;
+			reloadConf();
+		}
+
 		if (m_dmrNetwork->isConnected() && !m_xlxmodule.empty() && !m_xlxConnected) {
 			writeXLXLink(m_srcid, m_dstid, m_dmrNetwork);
 			LogMessage("XLX, Linking to reflector XLX%03u, module %s", m_xlxrefl, m_xlxmodule.c_str());
@@ -303,666 +413,258 @@ int CYSF2DMR::run()
 		}
 
 		if (m_wiresX != NULL) {
-			switch (TG_connect_state) {
-				case WAITING_UNLINK:
-					if (unlinkReceived) {
-						//LogMessage("Unlink Received");
-						TGChange.start();
-						TG_connect_state = SEND_REPLY;
-						unlinkReceived = false;
-					}
-					break;
+			// Set by the DMR ingress when the master ends the unlink transmission
+			if (m_unlinkReceived.exchange(false))
+				tgChange.unlinked();
+
+			switch (tgChange.clock(ms)) {
 				case SEND_REPLY:
-					if (TGChange.elapsed() > 600) {
-						TGChange.start();
-						TG_connect_state = SEND_PTT;
-						m_wiresX->sendConnectReply(m_dstid);
-					}
+					m_wiresX->sendConnectReply(m_dstid);
 					break;
 				case SEND_PTT:
-					if (TGChange.elapsed() > 600) {
-						TGChange.start();
-						TG_connect_state = NONE;
-						if (m_ptt_dstid) {
-							LogMessage("Sending PTT: Src: %s Dst: %s%d", m_ysfSrc.c_str(), m_ptt_pc ? "" : "TG ", m_ptt_dstid);
-							SendDummyDMR(m_srcid, m_ptt_dstid, m_ptt_pc ? FLCO_USER_USER : FLCO_GROUP);
-						}
+					if (m_ptt_dstid) {
+						LogMessage("Sending PTT: Src: %s Dst: %s%d", m_ysfSrc.c_str(), m_ptt_pc ? "" : "TG ", m_ptt_dstid);
+						SendDummyDMR(m_srcid, m_ptt_dstid, m_ptt_pc ? FLCO_USER_USER : FLCO_GROUP);
 					}
 					break;
 				default: 
 					break;
 			}
-
-			if ((TG_connect_state != NONE) && (TGChange.elapsed() > 12000)) {
-				LogMessage("Timeout changing TG");
-				TG_connect_state = NONE;
-			}
 		}
 
-		while (m_ysfNetwork->read(buffer) > 0U) {
-			CYSFFICH fich;
-			bool valid = fich.decode(buffer + 35U);
-
-			if (valid) {
-				unsigned char fi = fich.getFI();
-				unsigned char dt = fich.getDT();
-				unsigned char fn = fich.getFN();
-				unsigned char ft = fich.getFT();
-				
-				if (m_wiresX != NULL) {
-					WX_STATUS status = m_wiresX->process(buffer + 35U, buffer + 14U, fi, dt, fn, ft);
-					m_ysfSrc = getSrcYSF(buffer);
-
-					switch (status) {
-						case WXS_CONNECT:
-							m_srcid = findYSFID(m_ysfSrc, false);
-
-							m_ptt_dstid = m_wiresX->getDstID();
-							tglistOpt = m_wiresX->getOpt(m_ptt_dstid);
-
-							switch (tglistOpt) {
-								case 0:
-									m_ptt_pc = false;
-									m_dstid = m_wiresX->getFullDstID();
-									m_ptt_dstid = m_dstid;
-									m_dmrflco = FLCO_GROUP;
-									LogMessage("Connect to TG %d has been requested by %s", m_dstid, m_ysfSrc.c_str());
-									break;
-							
-								case 1:
-									m_ptt_pc = true;
-									m_dstid = 9U;
-									m_dmrflco = FLCO_GROUP;
-									LogMessage("Connect to REF %d has been requested by %s", m_ptt_dstid, m_ysfSrc.c_str());
-									break;
-								
-								case 2:
-									m_ptt_dstid = 0;
-									m_ptt_pc = true;
-									m_dstid = m_wiresX->getFullDstID();
-									m_dmrflco = FLCO_USER_USER;
-									LogMessage("Connect to %d has been requested by %s", m_dstid, m_ysfSrc.c_str());
-									break;
-							
-								default:
-									m_ptt_pc = false;
-									m_dstid = m_wiresX->getFullDstID();
-									m_ptt_dstid = m_dstid;
-									m_dmrflco = FLCO_GROUP;
-									LogMessage("Connect to TG %d has been requested by %s", m_dstid, m_ysfSrc.c_str());
-									break;
-							}
-
-							if (enableUnlink && (tglistOpt != 2) && (m_ptt_dstid != m_idUnlink) && (m_ptt_dstid != 5000)) {
-								LogMessage("Sending DMR Disconnect: Src: %s Dst: %s%d", m_ysfSrc.c_str(), m_flcoUnlink == FLCO_GROUP ? "TG " : "", m_idUnlink);
+		for (;;) {
+			unsigned char ysfBuffer[YSF_FICH_BATCH][256U];
+			const unsigned char* fichData[YSF_FICH_BATCH];
+			unsigned int nFrames = 0U;
 
-								SendDummyDMR(m_srcid, m_idUnlink, m_flcoUnlink);
-
-								unlinkReceived = false;
-								TG_connect_state = WAITING_UNLINK;
-							} else 
-								TG_connect_state = SEND_REPLY;
-
-							TGChange.start();
-							break;
-
-						case WXS_DX:
-							break;
-
-						case WXS_DISCONNECT:
-							LogMessage("Disconnect has been requested by %s", m_ysfSrc.c_str());
-
-							m_srcid = findYSFID(m_ysfSrc, false);
-							m_ptt_dstid = 9U;
-							m_ptt_pc = false;
-							m_dstid = 9U;
-							m_dmrflco = FLCO_GROUP;
-
-							SendDummyDMR(m_srcid, m_idUnlink, m_flcoUnlink);
-
-							TG_connect_state = WAITING_UNLINK;
-
-							TGChange.start();
-							break;
-
-						default:
-							break;
-					}
+			while ((nFrames < YSF_FICH_BATCH) && (m_ysfNetwork->read(ysfBuffer[nFrames]) > 0U)) {
+				fichData[nFrames] = ysfBuffer[nFrames] + 35U;
+				nFrames++;
+			}
 
-					status = WXS_NONE;
+			if (nFrames == 0U)
+				break;
 
-					if (dt == YSF_DT_VD_MODE2)
-						status = m_dtmf->decodeVDMode2(buffer + 35U, (buffer[34U] & 0x01U) == 0x01U);
+			CYSFFICH fichs[YSF_FICH_BATCH];
+			bool fichValid[YSF_FICH_BATCH];
+			CYSFFICH::decode(fichData, fichs, fichValid, nFrames);
 
-					switch (status) {
-						case WXS_CONNECT:
-							m_srcid = findYSFID(m_ysfSrc, false);
+			for (unsigned int k = 0U; k < nFrames; k++) {
+				unsigned char* buffer = ysfBuffer[k];
+				CYSFFICH& fich = fichs[k];
+				bool valid = fichValid[k];
 
-							m_ptt_dstid = m_dtmf->getDstID();
-							tglistOpt = m_wiresX->getOpt(m_ptt_dstid);
+				if (valid) {
+					unsigned char fi = fich.getFI();
+					unsigned char dt = fich.getDT();
+					unsigned char fn = fich.getFN();
+					unsigned char ft = fich.getFT();
 
-							switch (tglistOpt) {
-								case 0:
-									m_ptt_pc = false;
-									m_dstid = m_wiresX->getFullDstID();
-									m_ptt_dstid = m_dstid;
-									m_dmrflco = FLCO_GROUP;
-									LogMessage("Connect to TG %d has been requested by %s", m_dstid, m_ysfSrc.c_str());
-									break;
+					CYSFIngress& ingress = m_bridges[2U]->m_ingress;
+					if (ysfIngress(*m_bridges[2U], buffer, fi))
+						m_ysfSrc = ingress.m_callsign;
+				
+					if (m_wiresX != NULL) {
+						WX_STATUS status = m_wiresX->process(buffer + 35U, buffer + 14U, fi, dt, fn, ft);
+
+						switch (status) {
+							case WXS_CONNECT:
+								m_srcid = ingressID(ingress);
+
+								m_ptt_dstid = m_wiresX->getDstID();
+								tglistOpt = m_wiresX->getOpt(m_ptt_dstid);
+
+								switch (tglistOpt) {
+									case 0:
+										m_ptt_pc = false;
+										m_dstid = m_wiresX->getFullDstID();
+										m_ptt_dstid = m_dstid;
+										m_dmrflco = FLCO_GROUP;
+										LogMessage("Connect to TG %d has been requested by %s", m_dstid, m_ysfSrc.c_str());
+										break;
 							
-								case 1:
-									m_ptt_pc = true;
-									m_dstid = 9U;
-									m_dmrflco = FLCO_GROUP;
-									LogMessage("Connect to REF %d has been requested by %s", m_ptt_dstid, m_ysfSrc.c_str());
-									break;
+									case 1:
+										m_ptt_pc = true;
+										m_dstid = 9U;
+										m_dmrflco = FLCO_GROUP;
+										LogMessage("Connect to REF %d has been requested by %s", m_ptt_dstid, m_ysfSrc.c_str());
+										break;
 								
-								case 2:
-									m_ptt_dstid = 0;
-									m_ptt_pc = true;
-									m_dstid = m_wiresX->getFullDstID();
-									m_dmrflco = FLCO_USER_USER;
-									LogMessage("Connect to %d has been requested by %s", m_dstid, m_ysfSrc.c_str());
-									break;
+									case 2:
+										m_ptt_dstid = 0;
+										m_ptt_pc = true;
+										m_dstid = m_wiresX->getFullDstID();
+										m_dmrflco = FLCO_USER_USER;
+										LogMessage("Connect to %d has been requested by %s", m_dstid, m_ysfSrc.c_str());
+										break;
 							
-								default:
-									m_ptt_pc = false;
-									m_dstid = m_wiresX->getFullDstID();
-									m_ptt_dstid = m_dstid;
-									m_dmrflco = FLCO_GROUP;
-									LogMessage("Connect to TG %d has been requested by %s", m_dstid, m_ysfSrc.c_str());
-									break;
-							}
-
-							LogMessage("Connect to %s%d via DTMF has been requested by %s", m_ptt_pc ? "" : "TG ", m_ptt_dstid, m_ysfSrc.c_str());
-
-							if (enableUnlink && (tglistOpt != 2) && (m_ptt_dstid != m_idUnlink) && (m_ptt_dstid != 5000)) {
-								LogMessage("Sending DMR Disconnect: Src: %s Dst: %s%d", m_ysfSrc.c_str(), m_flcoUnlink == FLCO_GROUP ? "TG " : "", m_idUnlink);
+									default:
+										m_ptt_pc = false;
+										m_dstid = m_wiresX->getFullDstID();
+										m_ptt_dstid = m_dstid;
+										m_dmrflco = FLCO_GROUP;
+										LogMessage("Connect to TG %d has been requested by %s", m_dstid, m_ysfSrc.c_str());
+										break;
+								}
+
+								if (enableUnlink && (tglistOpt != 2) && (m_ptt_dstid != m_idUnlink) && (m_ptt_dstid != 5000)) {
+									LogMessage("Sending DMR Disconnect: Src: %s Dst: %s%d", m_ysfSrc.c_str(), m_flcoUnlink == FLCO_GROUP ? "TG " : "", m_idUnlink);
+
+									SendDummyDMR(m_srcid, m_idUnlink, m_flcoUnlink);
+
+									m_unlinkReceived = false;
+									tgChange.start(true);
+								} else
+									tgChange.start(false);
+								break;
+
+							case WXS_DX:
+								break;
+
+							case WXS_DISCONNECT:
+								LogMessage("Disconnect has been requested by %s", m_ysfSrc.c_str());
+
+								m_srcid = ingressID(ingress);
+								m_ptt_dstid = 9U;
+								m_ptt_pc = false;
+								m_dstid = 9U;
+								m_dmrflco = FLCO_GROUP;
 
 								SendDummyDMR(m_srcid, m_idUnlink, m_flcoUnlink);
-							
-								unlinkReceived = false;
-								TG_connect_state = WAITING_UNLINK;
-							} else
-								TG_connect_state = SEND_REPLY;
-
-							TGChange.start();
-							break;
-
-						case WXS_DISCONNECT:
-							LogMessage("Disconnect via DTMF has been requested by %s", m_ysfSrc.c_str());
-
-							m_srcid = findYSFID(m_ysfSrc, false);
-							m_ptt_dstid = 9U;
-							m_ptt_pc = false;
-							m_dstid = 9U;
-							m_dmrflco = FLCO_GROUP;
-
-							SendDummyDMR(m_srcid, m_idUnlink, m_flcoUnlink);
-
-							TG_connect_state = WAITING_UNLINK;
-							TGChange.start();
-							break;
-
-						default:
-							break;
-					}
-				}
 
-				if ((::memcmp(buffer, "YSFD", 4U) == 0U) && (dt == YSF_DT_VD_MODE2)) {
-					CYSFPayload ysfPayload;
+								m_unlinkReceived = false;
+								tgChange.start(true);
+								break;
 
-					if (fi == YSF_FI_HEADER) {
-						if (ysfPayload.processHeaderData(buffer + 35U)) {
-							std::string ysfSrc = ysfPayload.getSource();
-							std::string ysfDst = ysfPayload.getDest();
-							LogMessage("Received YSF Header: Src: %s Dst: %s", ysfSrc.c_str(), ysfDst.c_str());
-							m_srcid = findYSFID(ysfSrc, true);
-							m_conv.putYSFHeader();
-							m_ysfFrames = 0U;
+							default:
+								break;
 						}
-					} else if (fi == YSF_FI_TERMINATOR) {
-						LogMessage("YSF received end of voice transmission, %.1f seconds", float(m_ysfFrames) / 10.0F);
-						m_conv.putYSFEOT();
-						m_ysfFrames = 0U;
-					} else if (fi == YSF_FI_COMMUNICATIONS) {
-						m_conv.putYSF(buffer + 35U);
-						m_ysfFrames++;
-					}
-				}
-
-				if (m_gps != NULL)
-					m_gps->data(buffer + 14U, buffer + 35U, fi, dt, fn, ft);
-				
-			}
-
-			if ((buffer[34U] & 0x01U) == 0x01U) {
-				if (m_gps != NULL)
-					m_gps->reset();
-				if (m_dtmf != NULL)
-					m_dtmf->reset();
-			}
-		}
-
-		if (dmrWatch.elapsed() > DMR_FRAME_PER) {
-			unsigned int dmrFrameType = m_conv.getDMR(m_dmrFrame);
-
-			if(dmrFrameType == TAG_HEADER) {
-				CDMRData rx_dmrdata;
-				dmr_cnt = 0U;
-
-				rx_dmrdata.setSlotNo(2U);
-				rx_dmrdata.setSrcId(m_srcid);
-				rx_dmrdata.setDstId(m_dstid);
-				rx_dmrdata.setFLCO(m_dmrflco);
-				rx_dmrdata.setN(0U);
-				rx_dmrdata.setSeqNo(0U);
-				rx_dmrdata.setBER(0U);
-				rx_dmrdata.setRSSI(0U);
-				rx_dmrdata.setDataType(DT_VOICE_LC_HEADER);
-
-				// Add sync
-				CSync::addDMRDataSync(m_dmrFrame, 0);
-
-				// Add SlotType
-				CDMRSlotType slotType;
-				slotType.setColorCode(m_colorcode);
-				slotType.setDataType(DT_VOICE_LC_HEADER);
-				slotType.getData(m_dmrFrame);
-	
-				// Full LC
-				CDMRLC dmrLC = CDMRLC(m_dmrflco, m_srcid, m_dstid);
-				CDMRFullLC fullLC;
-				fullLC.encode(dmrLC, m_dmrFrame, DT_VOICE_LC_HEADER);
-				m_EmbeddedLC.setLC(dmrLC);
-				
-				rx_dmrdata.setData(m_dmrFrame);
-				//CUtils::dump(1U, "DMR data:", m_dmrFrame, 33U);
-
-				for (unsigned int i = 0U; i < 3U; i++) {
-					rx_dmrdata.setSeqNo(dmr_cnt);
-					m_dmrNetwork->write(rx_dmrdata);
-					dmr_cnt++;
-				}
-
-				dmrWatch.start();
-			}
-			else if(dmrFrameType == TAG_EOT) {
-				CDMRData rx_dmrdata;
-				unsigned int n_dmr = (dmr_cnt - 3U) % 6U;
-				unsigned int fill = (6U - n_dmr);
-				
-				if (n_dmr) {
-					for (unsigned int i = 0U; i < fill; i++) {
-
-						CDMREMB emb;
-						CDMRData rx_dmrdata;
-
-						rx_dmrdata.setSlotNo(2U);
-						rx_dmrdata.setSrcId(m_srcid);
-						rx_dmrdata.setDstId(m_dstid);
-						rx_dmrdata.setFLCO(m_dmrflco);
-						rx_dmrdata.setN(n_dmr);
-						rx_dmrdata.setSeqNo(dmr_cnt);
-						rx_dmrdata.setBER(0U);
-						rx_dmrdata.setRSSI(0U);
-						rx_dmrdata.setDataType(DT_VOICE);
-
-						::memcpy(m_dmrFrame, DMR_SILENCE_DATA, DMR_FRAME_LENGTH_BYTES);
-
-						// Generate the Embedded LC
-						unsigned char lcss = m_EmbeddedLC.getData(m_dmrFrame, n_dmr);
-
-						// Generate the EMB
-						emb.setColorCode(m_colorcode);
-						emb.setLCSS(lcss);
-						emb.getData(m_dmrFrame);
-
-						rx_dmrdata.setData(m_dmrFrame);
-				
-						//CUtils::dump(1U, "DMR data:", m_dmrFrame, 33U);
-						m_dmrNetwork->write(rx_dmrdata);
-
-						n_dmr++;
-						dmr_cnt++;
-					}
-				}
-
-				rx_dmrdata.setSlotNo(2U);
-				rx_dmrdata.setSrcId(m_srcid);
-				rx_dmrdata.setDstId(m_dstid);
-				rx_dmrdata.setFLCO(m_dmrflco);
-				rx_dmrdata.setN(n_dmr);
-				rx_dmrdata.setSeqNo(dmr_cnt);
-				rx_dmrdata.setBER(0U);
-				rx_dmrdata.setRSSI(0U);
-				rx_dmrdata.setDataType(DT_TERMINATOR_WITH_LC);
-
-				// Add sync
-				CSync::addDMRDataSync(m_dmrFrame, 0);
-
-				// Add SlotType
-				CDMRSlotType slotType;
-				slotType.setColorCode(m_colorcode);
-				slotType.setDataType(DT_TERMINATOR_WITH_LC);
-				slotType.getData(m_dmrFrame);
-	
-				// Full LC
-				CDMRLC dmrLC = CDMRLC(m_dmrflco, m_srcid, m_dstid);
-				CDMRFullLC fullLC;
-				fullLC.encode(dmrLC, m_dmrFrame, DT_TERMINATOR_WITH_LC);
-				
-				rx_dmrdata.setData(m_dmrFrame);
-				//CUtils::dump(1U, "DMR data:", m_dmrFrame, 33U);
-				m_dmrNetwork->write(rx_dmrdata);
-
-				dmrWatch.start();
-			}
-			else if(dmrFrameType == TAG_DATA) {
-				CDMREMB emb;
-				CDMRData rx_dmrdata;
-				unsigned int n_dmr = (dmr_cnt - 3U) % 6U;
-
-				rx_dmrdata.setSlotNo(2U);
-				rx_dmrdata.setSrcId(m_srcid);
-				rx_dmrdata.setDstId(m_dstid);
-				rx_dmrdata.setFLCO(m_dmrflco);
-				rx_dmrdata.setN(n_dmr);
-				rx_dmrdata.setSeqNo(dmr_cnt);
-				rx_dmrdata.setBER(0U);
-				rx_dmrdata.setRSSI(0U);
-			
-				if (!n_dmr) {
-					rx_dmrdata.setDataType(DT_VOICE_SYNC);
-					// Add sync
-					CSync::addDMRAudioSync(m_dmrFrame, 0U);
-					// Prepare Full LC data
-					CDMRLC dmrLC = CDMRLC(m_dmrflco, m_srcid, m_dstid);
-					// Configure the Embedded LC
-					m_EmbeddedLC.setLC(dmrLC);
-				}
-				else {
-					rx_dmrdata.setDataType(DT_VOICE);
-					// Generate the Embedded LC
-					unsigned char lcss = m_EmbeddedLC.getData(m_dmrFrame, n_dmr);
-					// Generate the EMB
-					emb.setColorCode(m_colorcode);
-					emb.setLCSS(lcss);
-					emb.getData(m_dmrFrame);
-				}
 
-				rx_dmrdata.setData(m_dmrFrame);
-				
-				//CUtils::dump(1U, "DMR data:", m_dmrFrame, 33U);
-				m_dmrNetwork->write(rx_dmrdata);
-
-				dmr_cnt++;
-				dmrWatch.start();
-			}
-		}
+						status = WXS_NONE;
 
-		while (m_dmrNetwork->read(tx_dmrdata) > 0U) {
-			unsigned int SrcId = tx_dmrdata.getSrcId();
-			unsigned int DstId = tx_dmrdata.getDstId();
-			
-			FLCO netflco = tx_dmrdata.getFLCO();
-			unsigned char DataType = tx_dmrdata.getDataType();
+						if (dt == YSF_DT_VD_MODE2)
+							status = m_dtmf->decodeVDMode2(buffer + 35U, (buffer[34U] & 0x01U) == 0x01U);
 
-			if (!tx_dmrdata.isMissing()) {
-				networkWatchdog.start();
+						switch (status) {
+							case WXS_CONNECT:
+								m_srcid = ingressID(ingress);
 
-				if(DataType == DT_TERMINATOR_WITH_LC) {
-					LogMessage("DMR received end of voice transmission, %.1f seconds", float(m_dmrFrames) / 16.667F);
+								m_ptt_dstid = m_dtmf->getDstID();
+								tglistOpt = m_wiresX->getOpt(m_ptt_dstid);
 
-					if (SrcId == 4000)
-						unlinkReceived = true;
+								switch (tglistOpt) {
+									case 0:
+										m_ptt_pc = false;
+										m_dstid = m_wiresX->getFullDstID();
+										m_ptt_dstid = m_dstid;
+										m_dmrflco = FLCO_GROUP;
+										LogMessage("Connect to TG %d has been requested by %s", m_dstid, m_ysfSrc.c_str());
+										break;
+							
+									case 1:
+										m_ptt_pc = true;
+										m_dstid = 9U;
+										m_dmrflco = FLCO_GROUP;
+										LogMessage("Connect to REF %d has been requested by %s", m_ptt_dstid, m_ysfSrc.c_str());
+										break;
+								
+									case 2:
+										m_ptt_dstid = 0;
+										m_ptt_pc = true;
+										m_dstid = m_wiresX->getFullDstID();
+										m_dmrflco = FLCO_USER_USER;
+										LogMessage("Connect to %d has been requested by %s", m_dstid, m_ysfSrc.c_str());
+										break;
+							
+									default:
+										m_ptt_pc = false;
+										m_dstid = m_wiresX->getFullDstID();
+										m_ptt_dstid = m_dstid;
+										m_dmrflco = FLCO_GROUP;
+										LogMessage("Connect to TG %d has been requested by %s", m_dstid, m_ysfSrc.c_str());
+										break;
+								}
 
-					m_conv.putDMREOT();
-					m_dmrNetwork->reset(2U);
-					networkWatchdog.stop();
-					m_dmrFrames = 0U;
-					m_dmrinfo = false;
-				}
+								LogMessage("Connect to %s%d via DTMF has been requested by %s", m_ptt_pc ? "" : "TG ", m_ptt_dstid, m_ysfSrc.c_str());
 
-				if((DataType == DT_VOICE_LC_HEADER) && (DataType != m_dmrLastDT)) {
-					
-					// DT1 & DT2 without GPS info
-					::memcpy(gps_buffer, dt1_temp, 10U);
-					::memcpy(gps_buffer + 10U, dt2_temp, 10U);
+								if (enableUnlink && (tglistOpt != 2) && (m_ptt_dstid != m_idUnlink) && (m_ptt_dstid != 5000)) {
+									LogMessage("Sending DMR Disconnect: Src: %s Dst: %s%d", m_ysfSrc.c_str(), m_flcoUnlink == FLCO_GROUP ? "TG " : "", m_idUnlink);
 
-					if (SrcId == 9990U)
-						m_netSrc = "PARROT";
-					else if (SrcId == 9U)
-						m_netSrc = "LOCAL";
-					else if (SrcId == 4000U)
-						m_netSrc = "UNLINK";
-					else
-						m_netSrc = m_lookup->findCS(SrcId);
+									SendDummyDMR(m_srcid, m_idUnlink, m_flcoUnlink);
 
-					m_netDst = (netflco == FLCO_GROUP ? "TG " : "") + m_lookup->findCS(DstId);
+									m_unlinkReceived = false;
+									tgChange.start(true);
+								} else
+									tgChange.start(false);
+								break;
 
-					m_conv.putDMRHeader();
-					LogMessage("DMR audio received from %s to %s", m_netSrc.c_str(), m_netDst.c_str());
+							case WXS_DISCONNECT:
+								LogMessage("Disconnect via DTMF has been requested by %s", m_ysfSrc.c_str());
 
-					m_dmrinfo = true;
+								m_srcid = ingressID(ingress);
+								m_ptt_dstid = 9U;
+								m_ptt_pc = false;
+								m_dstid = 9U;
+								m_dmrflco = FLCO_GROUP;
 
-					if (m_lookup->exists(SrcId) && (m_APRS != NULL)) {
-						int lat, lon, resp;
-						resp = m_APRS->findCall(m_netSrc, &lat, &lon);
+								SendDummyDMR(m_srcid, m_idUnlink, m_flcoUnlink);
 
-						//LogMessage("Searching GPS Position of %s in aprs.fi", m_netSrc.c_str());
+								m_unlinkReceived = false;
+								tgChange.start(true);
+								break;
 
-						if (resp) {
-							LogMessage("GPS Position of %s Lat: %0.3f, Lon: %0.3f", m_netSrc.c_str(), (float)lat / 1000.0, (float)lon / 1000.0);
-							m_APRS->formatGPS(gps_buffer, lat, lon);
+							default:
+								break;
 						}
-						// else
-						//	LogMessage("GPS Position not available");
 					}
 
-					m_netSrc.resize(YSF_CALLSIGN_LENGTH, ' ');
-					m_netDst.resize(YSF_CALLSIGN_LENGTH, ' ');
-					
-					m_dmrFrames = 0U;
-				}
-
-				if(DataType == DT_VOICE_SYNC || DataType == DT_VOICE) {
-					unsigned char dmr_frame[50];
-
-					tx_dmrdata.getData(dmr_frame);
-
-					if (!m_dmrinfo) {
-						if (SrcId == 9990U)
-							m_netSrc = "PARROT";
-						else if (SrcId == 9U)
-							m_netSrc = "LOCAL";
-						else if (SrcId == 4000U)
-							m_netSrc = "UNLINK";
-						else
-							m_netSrc = m_lookup->findCS(SrcId);
-
-						m_netDst = (netflco == FLCO_GROUP ? "TG " : "") + m_lookup->findCS(DstId);
-
-						LogMessage("DMR audio received from %s to %s", m_netSrc.c_str(), m_netDst.c_str());
-						
-						if (m_lookup->exists(SrcId) && (m_APRS != NULL)) {
-							int lat, lon, resp;
-							resp = m_APRS->findCall(m_netSrc, &lat, &lon);
-
-							//LogMessage("Searching GPS Position of %s in aprs.fi", m_netSrc.c_str());
-
-							if (resp) {
-								LogMessage("GPS Position of %s Lat: %0.3f, Lon: %0.3f", m_netSrc.c_str(), (float)lat / 1000.0, (float)lon / 1000.0);
-								m_APRS->formatGPS(gps_buffer, lat, lon);
+					if ((::memcmp(buffer, "YSFD", 4U) == 0U) && (dt == YSF_DT_VD_MODE2)) {
+						if (fi == YSF_FI_HEADER) {
+							char ysfSrc[YSF_CALLSIGN_LENGTH + 1U];
+							char ysfDst[YSF_CALLSIGN_LENGTH + 1U];
+							if (CYSFPayload::readHeaderData(buffer + 35U, ysfDst, ysfSrc)) {
+								LogMessage("Received YSF Header: Src: %s Dst: %s", ysfSrc, ysfDst);
+								m_srcid = findYSFID(ysfSrc, true);
+								ingress.m_srcId = m_srcid;
+								writeYSFQueue(*m_bridges[2U], TAG_HEADER, m_srcid, m_dstid, m_dmrflco, NULL);
+								heardYSFStart(*m_bridges[2U], ysfSrc, m_srcid, m_dstid, m_dmrflco);
+								m_ysfFrames = 0U;
 							}
-							// else
-							//	LogMessage("GPS Position not available");
+						} else if (fi == YSF_FI_TERMINATOR) {
+							LogMessage("YSF received end of voice transmission, %.1f seconds", float(m_ysfFrames) / 10.0F);
+							writeYSFQueue(*m_bridges[2U], TAG_EOT, m_srcid, m_dstid, m_dmrflco, NULL);
+							heardYSFEnd(*m_bridges[2U], m_ysfFrames);
+							m_ysfFrames = 0U;
+						} else if (fi == YSF_FI_COMMUNICATIONS) {
+							writeYSFQueue(*m_bridges[2U], TAG_DATA, m_srcid, m_dstid, m_dmrflco, buffer + 35U);
+							heardYSFData(*m_bridges[2U], fn, ft);
+							m_ysfFrames++;
 						}
-
-						m_netSrc.resize(YSF_CALLSIGN_LENGTH, ' ');
-						m_netDst.resize(YSF_CALLSIGN_LENGTH, ' ');
-
-						m_dmrinfo = true;
 					}
 
-					m_conv.putDMR(dmr_frame); // Add DMR frame for YSF conversion
-					m_dmrFrames++;
-				}
-			}
-			else {
-				if(DataType == DT_VOICE_SYNC || DataType == DT_VOICE) {
-					unsigned char dmr_frame[50];
-					tx_dmrdata.getData(dmr_frame);
-					m_conv.putDMR(dmr_frame); // Add DMR frame for YSF conversion
-					m_dmrFrames++;
-				}
-
-				networkWatchdog.clock(ms);
-				if (networkWatchdog.hasExpired()) {
-					LogDebug("Network watchdog has expired, %.1f seconds", float(m_dmrFrames) / 16.667F);
-					m_dmrNetwork->reset(2U);
-					networkWatchdog.stop();
-					m_dmrFrames = 0U;
-					m_dmrinfo = false;
-				}
-			}
-			
-			m_dmrLastDT = DataType;
-		}
-		
-		if (ysfWatch.elapsed() > YSF_FRAME_PER) {
-			unsigned int ysfFrameType = m_conv.getYSF(m_ysfFrame + 35U);
-
-			if(ysfFrameType == TAG_HEADER) {
-				ysf_cnt = 0U;
-
-				::memcpy(m_ysfFrame + 0U, "YSFD", 4U);
-				::memcpy(m_ysfFrame + 4U, m_ysfNetwork->getCallsign().c_str(), YSF_CALLSIGN_LENGTH);
-				::memcpy(m_ysfFrame + 14U, m_netSrc.c_str(), YSF_CALLSIGN_LENGTH);
-				::memcpy(m_ysfFrame + 24U, "ALL       ", YSF_CALLSIGN_LENGTH);
-				m_ysfFrame[34U] = 0U; // Net frame counter
-
-				CSync::addYSFSync(m_ysfFrame + 35U);
-
-				// Set the FICH
-				CYSFFICH fich;
-				fich.setFI(YSF_FI_HEADER);
-				fich.setCS(2U);
-				fich.setFN(0U);
-				fich.setFT(7U);
-				fich.setDev(0U);
-				fich.setMR(2U);
-				fich.setDT(YSF_DT_VD_MODE2);
-				fich.setSQL(0U);
-				fich.setSQ(0U);
-				fich.encode(m_ysfFrame + 35U);
-
-				unsigned char csd1[20U], csd2[20U];
-				memset(csd1, '*', YSF_CALLSIGN_LENGTH);
-				memcpy(csd1 + YSF_CALLSIGN_LENGTH, m_netSrc.c_str(), YSF_CALLSIGN_LENGTH);
-				memset(csd2, ' ', YSF_CALLSIGN_LENGTH + YSF_CALLSIGN_LENGTH);
-
-				CYSFPayload payload;
-				payload.writeHeader(m_ysfFrame + 35U, csd1, csd2);
-
-				m_ysfNetwork->write(m_ysfFrame);
+					if (m_gps != NULL)
+						m_gps->data(buffer + 14U, buffer + 35U, fi, dt, fn, ft);
 				
-				ysf_cnt++;
-				ysfWatch.start();
-			}
-			else if (ysfFrameType == TAG_EOT) {
-				::memcpy(m_ysfFrame + 0U, "YSFD", 4U);
-				::memcpy(m_ysfFrame + 4U, m_ysfNetwork->getCallsign().c_str(), YSF_CALLSIGN_LENGTH);
-				::memcpy(m_ysfFrame + 14U, m_netSrc.c_str(), YSF_CALLSIGN_LENGTH);
-				::memcpy(m_ysfFrame + 24U, "ALL       ", YSF_CALLSIGN_LENGTH);
-				m_ysfFrame[34U] = ysf_cnt; // Net frame counter
-
-				CSync::addYSFSync(m_ysfFrame + 35U);
-
-				// Set the FICH
-				CYSFFICH fich;
-				fich.setFI(YSF_FI_TERMINATOR);
-				fich.setCS(2U);
-				fich.setFN(0U);
-				fich.setFT(7U);
-				fich.setDev(0U);
-				fich.setMR(2U);
-				fich.setDT(YSF_DT_VD_MODE2);
-				fich.setSQL(0U);
-				fich.setSQ(0U);
-				fich.encode(m_ysfFrame + 35U);
-
-				unsigned char csd1[20U], csd2[20U];
-				memset(csd1, '*', YSF_CALLSIGN_LENGTH);
-				memcpy(csd1 + YSF_CALLSIGN_LENGTH, m_netSrc.c_str(), YSF_CALLSIGN_LENGTH);
-				memset(csd2, ' ', YSF_CALLSIGN_LENGTH + YSF_CALLSIGN_LENGTH);
-
-				CYSFPayload payload;
-				payload.writeHeader(m_ysfFrame + 35U, csd1, csd2);
-
-				m_ysfNetwork->write(m_ysfFrame);
-			}
-			else if (ysfFrameType == TAG_DATA) {
-				CYSFFICH fich;
-				CYSFPayload ysfPayload;
-
-				unsigned int fn = (ysf_cnt - 1U) % 8U;
-
-				::memcpy(m_ysfFrame + 0U, "YSFD", 4U);
-				::memcpy(m_ysfFrame + 4U, m_ysfNetwork->getCallsign().c_str(), YSF_CALLSIGN_LENGTH);
-				::memcpy(m_ysfFrame + 14U, m_netSrc.c_str(), YSF_CALLSIGN_LENGTH);
-				::memcpy(m_ysfFrame + 24U, "ALL       ", YSF_CALLSIGN_LENGTH);
-
-				// Add the YSF Sync
-				CSync::addYSFSync(m_ysfFrame + 35U);
-
-				switch (fn) {
-					case 0:
-						ysfPayload.writeVDMode2Data(m_ysfFrame + 35U, (const unsigned char*)"**********");
-						break;
-					case 1:
-						ysfPayload.writeVDMode2Data(m_ysfFrame + 35U, (const unsigned char*)m_netSrc.c_str());
-						break;
-					case 2:
-						ysfPayload.writeVDMode2Data(m_ysfFrame + 35U, (const unsigned char*)m_netDst.c_str());
-						break;
-					case 6:
-						ysfPayload.writeVDMode2Data(m_ysfFrame + 35U, gps_buffer);
-						break;
-					case 7:
-						ysfPayload.writeVDMode2Data(m_ysfFrame + 35U, gps_buffer+10U);
-						break;
-					default:
-						ysfPayload.writeVDMode2Data(m_ysfFrame + 35U, (const unsigned char*)"          ");
 				}
-				
-				// Set the FICH
-				fich.setFI(YSF_FI_COMMUNICATIONS);
-				fich.setCS(2U);
-				fich.setFN(fn);
-				fich.setFT(7U);
-				fich.setDev(0U);
-				fich.setMR(YSF_MR_BUSY);
-				fich.setDT(YSF_DT_VD_MODE2);
-				fich.setSQL(0U);
-				fich.setSQ(0U);
-				fich.encode(m_ysfFrame + 35U);
 
-				// Net frame counter
-				m_ysfFrame[34U] = (ysf_cnt & 0x7FU) << 1;
-
-				// Send data to MMDVMHost
-				m_ysfNetwork->write(m_ysfFrame);
-				
-				ysf_cnt++;
-				ysfWatch.start();
+				if ((buffer[34U] & 0x01U) == 0x01U) {
+					m_bridges[2U]->m_ingress.m_active = false;
+					if (m_gps != NULL)
+						m_gps->reset();
+					if (m_dtmf != NULL)
+						m_dtmf->reset();
+				}
 			}
 		}
 
 		stopWatch.start();
 
 		m_ysfNetwork->clock(ms);
-		m_dmrNetwork->clock(ms);
+
+		if (m_bridges[1U] != NULL) {
+			m_bridges[1U]->m_ysfNetwork->clock(ms);
+			readSlotYSF(*m_bridges[1U]);
+		}
 
 		if (m_wiresX != NULL)
 			m_wiresX->clock(ms);
@@ -973,18 +675,41 @@ int CYSF2DMR::run()
 		pollTimer.clock(ms);
 		if (pollTimer.isRunning() && pollTimer.hasExpired()) {
 			m_ysfNetwork->writePoll();
+			if (m_bridges[1U] != NULL)
+				m_bridges[1U]->m_ysfNetwork->writePoll();
 			pollTimer.start();
 		}
 
-		if (m_xlxReflectors != NULL)
-			m_xlxReflectors->clock(ms);
-
 		if (ms < 5U)
 			CThread::sleep(5U);
 	}
 
+	dmrIngress.wait();
+	ysf2dmr.wait();
+	dmr2ysf.wait();
+	if (m_bridges[1U] != NULL) {
+		ysf2dmr1.wait();
+		dmr2ysf1.wait();
+	}
+
+	// Before any of its listeners go
+	m_watcher->stop();
+
 	m_ysfNetwork->close();
 	m_dmrNetwork->close();
+
+	for (std::vector<CDMRNetwork*>::iterator it = m_fanOutNetworks.begin(); it != m_fanOutNetworks.end(); ++it) {
+		(*it)->close();
+		delete *it;
+	}
+
+	if (m_bridges[1U] != NULL) {
+		m_bridges[1U]->m_ysfNetwork->close();
+		delete m_bridges[1U]->m_ysfNetwork;
+		delete m_bridges[1U];
+	}
+
+	delete m_bridges[2U];
 	
 	if (m_APRS != NULL) {
 		m_APRS->stop();
@@ -995,6 +720,11 @@ int CYSF2DMR::run()
 		m_gps->close();
 		delete m_gps;
 	}
+
+	if (m_lastHeard != NULL) {
+		m_lastHeard->close();
+		delete m_lastHeard;
+	}
 	
 	delete m_dmrNetwork;
 	delete m_ysfNetwork;
@@ -1007,33 +737,194 @@ int CYSF2DMR::run()
 	if (m_xlxReflectors != NULL)
 		delete m_xlxReflectors;
 
+	delete m_lookup;
+	delete m_watcher;
+
+	CResolver::stop();
+
 	::LogFinalise();
 
 	return 0;
 }
 
-void CYSF2DMR::createGPS()
+#if !defined(_WIN32) && !defined(_WIN64)
+// Done after any fork, as neither the memory locks nor the limits would carry
+// across it, and before dropping root, which could no longer raise the limits.
+// With MCL_FUTURE everything set up afterwards is locked as it is mapped.
+void CYSF2DMR::prepareRealTime()
 {
-	std::string hostname = m_conf.getAPRSServer();
-	unsigned int port    = m_conf.getAPRSPort();
-	std::string password = m_conf.getAPRSPassword();
-	std::string desc     = m_conf.getAPRSDescription();
-
-	LogMessage("APRS Parameters");
-	LogMessage("    Server: %s", hostname.c_str());
-	LogMessage("    Port: %u", port);
-	LogMessage("    Passworwd: %s", password.c_str());
-	LogMessage("    Description: %s", desc.c_str());
+	unsigned int priority = m_conf.getTranscoderPriority();
+	if (priority > 0U) {
+		// Root does not need the limit, the mmdvm user it becomes does
+		struct rlimit limit;
+		::getrlimit(RLIMIT_RTPRIO, &limit);
+		if (limit.rlim_cur < priority) {
+			limit.rlim_cur = priority;
+			if (limit.rlim_max < priority)
+				limit.rlim_max = priority;
+
+			if (::setrlimit(RLIMIT_RTPRIO, &limit) != 0)
+				LogWarning("Cannot raise the real time priority limit, err=%d", errno);
+		}
 
-	m_gps = new CGPS(m_callsign, m_suffix, password, hostname, port);
+		LogMessage("Voice threads run at %s priority %u", m_conf.getTranscoderRoundRobin() ? "RR" : "FIFO", priority);
+	}
 
-	unsigned int txFrequency = m_conf.getTxFrequency();
-	unsigned int rxFrequency = m_conf.getRxFrequency();
-	float latitude           = m_conf.getLatitude();
-	float longitude          = m_conf.getLongitude();
-	int height               = m_conf.getHeight();
+	if (m_conf.getTranscoderLockMemory()) {
+		struct rlimit limit;
+		limit.rlim_cur = RLIM_INFINITY;
+		limit.rlim_max = RLIM_INFINITY;
+		::setrlimit(RLIMIT_MEMLOCK, &limit);
+
+		// Every page mapped from now on is resident, so the default 8MB thread
+		// stacks and a malloc arena per thread would cost hundreds of MB
+		CThread::setStackSize(512U * 1024U);
+#if defined(__GLIBC__)
+		::mallopt(M_ARENA_MAX, 1);
+#endif
 
-	m_gps->setInfo(txFrequency, rxFrequency, latitude, longitude, height, desc);
+		if (::mlockall(MCL_CURRENT | MCL_FUTURE) != 0)
+			LogWarning("Cannot lock the memory, err=%d", errno);
+		else
+			LogMessage("Memory locked");
+	}
+}
+#else
+void CYSF2DMR::prepareRealTime()
+{
+}
+#endif
+
+// Applies the changes that need neither the DMR login nor the YSF sockets to
+// be set up again. The master is only logged into again when its address or
+// credentials have changed, the rest waits for the next start.
+void CYSF2DMR::reloadConf()
+{
+	CConf conf(m_configFile);
+	if (!conf.read()) {
+		LogWarning("Cannot read %s, keeping the running configuration", m_configFile.c_str());
+		return;
+	}
+
+	LogMessage("Reloading the configuration from %s", m_configFile.c_str());
+
+	if (conf.getLogFilePath() != m_conf.getLogFilePath() || conf.getLogFileRoot() != m_conf.getLogFileRoot() ||
+	    conf.getLogFileLevel() != m_conf.getLogFileLevel() || conf.getLogDisplayLevel() != m_conf.getLogDisplayLevel()) {
+		unsigned int logDisplayLevel = conf.getLogDisplayLevel();
+
+#if !defined(_WIN32) && !defined(_WIN64)
+		if (m_conf.getDaemon())
+			logDisplayLevel = 0U;
+#endif
+
+		if (::LogInitialise(conf.getLogFilePath(), conf.getLogFileRoot(), conf.getLogFileLevel(), logDisplayLevel))
+			LogMessage("    Logging to %s/%s, levels %u and %u", conf.getLogFilePath().c_str(), conf.getLogFileRoot().c_str(), conf.getLogFileLevel(), logDisplayLevel);
+	}
+
+	if (conf.getDMRNetworkJitter() != m_conf.getDMRNetworkJitter() && conf.getDMRNetworkJitter() > 0U) {
+		m_dmrNetwork->setJitter(conf.getDMRNetworkJitter());
+		LogMessage("    Jitter: %ums", conf.getDMRNetworkJitter());
+	}
+
+	// With XLX the master is the reflector's, found from the reflector list
+	if (m_xlxmodule.empty() && !conf.getDMRNetworkAddress().empty() && !conf.getDMRNetworkPassword().empty() &&
+	    (conf.getDMRNetworkAddress() != m_conf.getDMRNetworkAddress() || conf.getDMRNetworkPort() != m_conf.getDMRNetworkPort() ||
+	     conf.getDMRNetworkPassword() != m_conf.getDMRNetworkPassword() || conf.getDMRNetworkOptions() != m_conf.getDMRNetworkOptions())) {
+		LogMessage("    Master: %s:%u", conf.getDMRNetworkAddress().c_str(), conf.getDMRNetworkPort());
+		m_dmrNetwork->setMaster(conf.getDMRNetworkAddress(), conf.getDMRNetworkPort(), conf.getDMRNetworkPassword(), conf.getDMRNetworkOptions());
+	}
+
+	// Only followed while nobody has moved the bridge off the old one
+	if (m_xlxmodule.empty() && (conf.getDMRDstId() != m_conf.getDMRDstId() || conf.getDMRPC() != m_conf.getDMRPC())) {
+		FLCO flco = m_conf.getDMRPC() ? FLCO_USER_USER : FLCO_GROUP;
+
+		if (m_dstid == m_conf.getDMRDstId() && m_dmrflco == flco) {
+			m_dstid   = conf.getDMRDstId();
+			m_dmrpc   = conf.getDMRPC();
+			m_dmrflco = m_dmrpc ? FLCO_USER_USER : FLCO_GROUP;
+			LogMessage("    Startup DstID: %s%u", m_dmrpc ? "" : "TG ", m_dstid);
+		} else {
+			LogMessage("    Startup DstID: %s%u, staying on %s%u for now", conf.getDMRPC() ? "" : "TG ", conf.getDMRDstId(), m_dmrflco == FLCO_GROUP ? "TG " : "", m_dstid);
+		}
+	}
+
+	// Changes to the files under the same names are left to the file watcher
+	if (m_wiresX != NULL && conf.getDMRTGListFile() != m_TGList) {
+		m_TGList = conf.getDMRTGListFile();
+		m_watcher->remove(m_wiresX);
+		m_watcher->add(m_TGList, m_wiresX, true);
+		LogMessage("    TGList file: %s", m_TGList.c_str());
+	}
+
+	std::string lookupFile  = conf.getDMRIdLookupFile();
+	unsigned int reloadTime = conf.getDMRIdLookupTime();
+	bool lookupChanged      = lookupFile != m_conf.getDMRIdLookupFile();
+	if (lookupChanged || (reloadTime > 0U) != (m_conf.getDMRIdLookupTime() > 0U)) {
+		m_watcher->remove(m_lookup);
+		m_lookup->setFile(lookupFile);
+
+		if (reloadTime > 0U)
+			m_watcher->add(lookupFile, m_lookup, lookupChanged);
+		else if (lookupChanged)
+			m_watcher->load(lookupFile, m_lookup);
+
+		LogMessage("    DMR Id lookup file: %s, %s", lookupFile.c_str(), reloadTime > 0U ? "reloaded when changed" : "not reloaded");
+	}
+
+	bool gps = false;
+
+	if (conf.getAPRSEnabled() != m_conf.getAPRSEnabled()) {
+		LogWarning("    aprs.fi Enable only changes on the next start");
+	} else if (conf.getAPRSEnabled()) {
+		if (conf.getAPRSAPIKey() != m_conf.getAPRSAPIKey() || conf.getAPRSRefresh() != m_conf.getAPRSRefresh() ||
+		    conf.getAPRSAPIServer() != m_conf.getAPRSAPIServer() || conf.getAPRSAPIPort() != m_conf.getAPRSAPIPort()) {
+			m_APRS->setServer(conf.getAPRSAPIKey(), conf.getAPRSRefresh(), conf.getAPRSAPIServer(), conf.getAPRSAPIPort());
+			LogMessage("    aprs.fi lookups: %s:%u", conf.getAPRSAPIServer().c_str(), conf.getAPRSAPIPort());
+		}
+
+		// Only the APRS-IS connection is made again for these
+		gps = conf.getAPRSServer() != m_conf.getAPRSServer() || conf.getAPRSPort() != m_conf.getAPRSPort() ||
+		           conf.getAPRSPassword() != m_conf.getAPRSPassword() || conf.getAPRSDescription() != m_conf.getAPRSDescription() ||
+		           conf.getTxFrequency() != m_conf.getTxFrequency() || conf.getRxFrequency() != m_conf.getRxFrequency() ||
+		           conf.getLatitude() != m_conf.getLatitude() || conf.getLongitude() != m_conf.getLongitude() || conf.getHeight() != m_conf.getHeight();
+	}
+
+	m_conf = conf;
+
+	// From the new settings
+	if (gps) {
+		if (m_gps != NULL) {
+			m_gps->close();
+			delete m_gps;
+			m_gps = NULL;
+		}
+
+		createGPS();
+	}
+}
+
+void CYSF2DMR::createGPS()
+{
+	std::string hostname = m_conf.getAPRSServer();
+	unsigned int port    = m_conf.getAPRSPort();
+	std::string password = m_conf.getAPRSPassword();
+	std::string desc     = m_conf.getAPRSDescription();
+
+	LogMessage("APRS Parameters");
+	LogMessage("    Server: %s", hostname.c_str());
+	LogMessage("    Port: %u", port);
+	LogMessage("    Passworwd: %s", password.c_str());
+	LogMessage("    Description: %s", desc.c_str());
+
+	m_gps = new CGPS(m_callsign, m_suffix, password, hostname, port);
+
+	unsigned int txFrequency = m_conf.getTxFrequency();
+	unsigned int rxFrequency = m_conf.getRxFrequency();
+	float latitude           = m_conf.getLatitude();
+	float longitude          = m_conf.getLongitude();
+	int height               = m_conf.getHeight();
+
+	m_gps->setInfo(txFrequency, rxFrequency, latitude, longitude, height, desc);
 
 	bool ret = m_gps->open();
 	if (!ret) {
@@ -1046,13 +937,11 @@ void CYSF2DMR::createGPS()
 void CYSF2DMR::SendDummyDMR(unsigned int srcid,unsigned int dstid, FLCO dmr_flco)
 {
 	CDMRData dmrdata;
-	CDMRSlotType slotType;
-	CDMRFullLC fullLC;
 
 	int dmr_cnt = 0U;
 
-	// Generate DMR LC for header and TermLC frames
-	CDMRLC dmrLC = CDMRLC(dmr_flco, srcid, dstid);
+	// Get the encoded header and TermLC frames
+	const CDMRLCCacheEntry& dmrLC = m_lcCache.find(dmr_flco, srcid, dstid, m_colorcode);
 
 	// Build DMR header
 	dmrdata.setSlotNo(2U);
@@ -1065,16 +954,8 @@ void CYSF2DMR::SendDummyDMR(unsigned int srcid,unsigned int dstid, FLCO dmr_flco
 	dmrdata.setRSSI(0U);
 	dmrdata.setDataType(DT_VOICE_LC_HEADER);
 
-	// Add sync
-	CSync::addDMRDataSync(m_dmrFrame, 0);
-
-	// Add SlotType
-	slotType.setColorCode(m_colorcode);
-	slotType.setDataType(DT_VOICE_LC_HEADER);
-	slotType.getData(m_dmrFrame);
-
-	// Full LC
-	fullLC.encode(dmrLC, m_dmrFrame, DT_VOICE_LC_HEADER);
+	// Full LC, SlotType and sync
+	dmrLC.getHeader(m_dmrFrame, false);
 
 	dmrdata.setData(m_dmrFrame);
 
@@ -1089,16 +970,8 @@ void CYSF2DMR::SendDummyDMR(unsigned int srcid,unsigned int dstid, FLCO dmr_flco
 	dmrdata.setSeqNo(dmr_cnt);
 	dmrdata.setDataType(DT_TERMINATOR_WITH_LC);
 
-	// Add sync
-	CSync::addDMRDataSync(m_dmrFrame, 0);
-
-	// Add SlotType
-	slotType.setColorCode(m_colorcode);
-	slotType.setDataType(DT_TERMINATOR_WITH_LC);
-	slotType.getData(m_dmrFrame);
-
-	// Full LC for TermLC frame
-	fullLC.encode(dmrLC, m_dmrFrame, DT_TERMINATOR_WITH_LC);
+	// Full LC, SlotType and sync for TermLC frame
+	dmrLC.getTerminator(m_dmrFrame, false);
 
 	dmrdata.setData(m_dmrFrame);
 
@@ -1106,28 +979,17 @@ void CYSF2DMR::SendDummyDMR(unsigned int srcid,unsigned int dstid, FLCO dmr_flco
 	m_dmrNetwork->write(dmrdata);
 }
 
-unsigned int CYSF2DMR::findYSFID(std::string cs, bool showdst)
+unsigned int CYSF2DMR::findYSFID(const char* cs, bool showdst)
 {
-	std::string cstrim;
+	assert(cs != NULL);
+
 	bool dmrpc = false;
 
-	int first = cs.find_first_not_of(' ');
-	int mid1 = cs.find_last_of('-');
-	int mid2 = cs.find_last_of('/');
-	int last = cs.find_last_not_of(' ');
-	
-	if (mid1 == -1 && mid2 == -1 && first == -1 && last == -1)
-		cstrim = "N0CALL";
-	else if (mid1 == -1 && mid2 == -1)
-		cstrim = cs.substr(first, (last - first + 1));
-	else if (mid1 > first)
-		cstrim = cs.substr(first, (mid1 - first));
-	else if (mid2 > first)
-		cstrim = cs.substr(first, (mid2 - first));
-	else
-		cstrim = "N0CALL";
+	unsigned int id = m_lookup->findID(cs, ::strlen(cs));
 
-	unsigned int id = m_lookup->findID(cstrim);
+	// Only for the log, the callsign as it was looked up
+	size_t first = ::strspn(cs, " ");
+	int length   = int(::strcspn(cs + first, " -/"));
 
 	if (m_dmrflco == FLCO_USER_USER)
 		dmrpc = true;
@@ -1143,25 +1005,55 @@ unsigned int CYSF2DMR::findYSFID(std::string cs, bool showdst)
 	}
 	else {
 		if (showdst)
-			LogMessage("DMR ID of %s: %u, DstID: %s%u", cstrim.c_str(), id, dmrpc ? "" : "TG ", m_dstid);
+			LogMessage("DMR ID of %.*s: %u, DstID: %s%u", length, cs + first, id, dmrpc ? "" : "TG ", m_dstid);
 		else
-			LogMessage("DMR ID of %s: %u", cstrim.c_str(), id);
+			LogMessage("DMR ID of %.*s: %u", length, cs + first, id);
 	}
 
 	return id;
 }
 
-std::string CYSF2DMR::getSrcYSF(const unsigned char* buffer)
+// A new stream is one after the end of the last, one with a new source, one
+// that starts with a header, or one whose network frame counter has gone
+// back, as after a lost header and end of stream. Returns whether a new one
+// has started.
+bool CYSF2DMR::ysfIngress(CBridgeSlot& bridge, const unsigned char* buffer, unsigned char fi)
 {
-	unsigned char temp[YSF_CALLSIGN_LENGTH + 1U];
+	assert(buffer != NULL);
 
-	::memcpy(temp, buffer + 14U, YSF_CALLSIGN_LENGTH);
-	temp[YSF_CALLSIGN_LENGTH] = 0U;
-	
-	std::string trimmed = reinterpret_cast<char const*>(temp);
-	trimmed.erase(std::find_if(trimmed.rbegin(), trimmed.rend(), std::not1(std::ptr_fun<int, int>(std::isspace))).base(), trimmed.end());
-	
-	return trimmed;
+	CYSFIngress& ingress = bridge.m_ingress;
+
+	// The counter is seven bits, a small step forward is a wrap or lost frames
+	unsigned char counter = buffer[34U] >> 1;
+	bool restarted = ((counter - ingress.m_counter) & 0x7FU) >= 0x40U;
+	ingress.m_counter = counter;
+
+	if (ingress.m_active && fi != YSF_FI_HEADER && !restarted && ::memcmp(ingress.m_source, buffer + 14U, YSF_CALLSIGN_LENGTH) == 0)
+		return false;
+
+	::memcpy(ingress.m_source, buffer + 14U, YSF_CALLSIGN_LENGTH);
+
+	unsigned int length = 0U;
+	while (length < YSF_CALLSIGN_LENGTH && buffer[14U + length] != 0x00U)
+		length++;
+	while (length > 0U && ::isspace(buffer[14U + length - 1U]))
+		length--;
+
+	::memcpy(ingress.m_callsign, buffer + 14U, length);
+	ingress.m_callsign[length] = 0x00;
+
+	ingress.m_active = true;
+	ingress.m_srcId  = 0U;
+
+	return true;
+}
+
+unsigned int CYSF2DMR::ingressID(CYSFIngress& ingress)
+{
+	if (ingress.m_srcId == 0U)
+		ingress.m_srcId = findYSFID(ingress.m_callsign, false);
+
+	return ingress.m_srcId;
 }
 
 bool CYSF2DMR::createDMRNetwork()
@@ -1174,9 +1066,9 @@ bool CYSF2DMR::createDMRNetwork()
 	std::string password = m_conf.getDMRNetworkPassword();
 	bool debug           = m_conf.getDMRNetworkDebug();
 	unsigned int jitter  = m_conf.getDMRNetworkJitter();
-	bool slot1           = false;
+	bool slot1           = m_conf.getSlot1Enabled();
 	bool slot2           = true;
-	bool duplex          = false;
+	bool duplex          = slot1;
 	HW_TYPE hwType       = HWT_MMDVM;
 
 	m_srcHS = m_conf.getDMRId();
@@ -1195,11 +1087,11 @@ bool CYSF2DMR::createDMRNetwork()
 		m_dstid = 4000 + xlxmod[0] - 64;
 		m_dmrpc = 0;
 
-		CReflector* reflector = m_xlxReflectors->find(m_xlxrefl);
-		if (reflector == NULL)
+		CReflector reflector;
+		if (!m_xlxReflectors->find(m_xlxrefl, reflector))
 			return false;
 		
-		address = reflector->m_address;
+		address = reflector.m_address;
 	}
 
 	if (pcUnlink)
@@ -1237,6 +1129,18 @@ bool CYSF2DMR::createDMRNetwork()
 		LogMessage("    Local: random");
 	LogMessage("    Jitter: %ums", jitter);
 
+	switch (m_conf.getDMRNetworkArbitration()) {
+	case DA_PRIORITY:
+		LogMessage("    Arbitration: priority TG %u", m_conf.getDMRNetworkPriorityTG());
+		break;
+	case DA_HANG:
+		LogMessage("    Arbitration: hang time %us", m_conf.getDMRNetworkHangTime());
+		break;
+	default:
+		LogMessage("    Arbitration: first come");
+		break;
+	}
+
 	m_dmrNetwork = new CDMRNetwork(address, port, local, m_srcHS, password, duplex, VERSION, debug, slot1, slot2, hwType, jitter);
 
 	std::string options = m_conf.getDMRNetworkOptions();
@@ -1245,6 +1149,31 @@ bool CYSF2DMR::createDMRNetwork()
 		m_dmrNetwork->setOptions(options);
 	}
 
+	std::vector<std::string> failovers = m_conf.getDMRNetworkFailovers();
+	for (std::vector<std::string>::const_iterator it = failovers.begin(); it != failovers.end(); ++it) {
+		std::string::size_type pos = it->rfind(':');
+		if (pos == std::string::npos || pos == 0U) {
+			LogWarning("    Invalid failover master: %s", it->c_str());
+			continue;
+		}
+
+		std::string  host = it->substr(0U, pos);
+		unsigned int port = (unsigned int)::atoi(it->c_str() + pos + 1U);
+		if (port == 0U) {
+			LogWarning("    Invalid failover master: %s", it->c_str());
+			continue;
+		}
+
+		LogMessage("    Failover: %s:%u", host.c_str(), port);
+		m_dmrNetwork->addMaster(host, port);
+	}
+
+	if (!failovers.empty()) {
+		bool standby = m_conf.getDMRNetworkStandby();
+		LogMessage("    Standby: %s", standby ? "yes" : "no");
+		m_dmrNetwork->setStandby(standby);
+	}
+
 	unsigned int rxFrequency = m_conf.getRxFrequency();
 	unsigned int txFrequency = m_conf.getTxFrequency();
 	unsigned int power       = m_conf.getPower();
@@ -1281,6 +1210,48 @@ bool CYSF2DMR::createDMRNetwork()
 	return true;
 }
 
+bool CYSF2DMR::createFanOutNetworks()
+{
+	std::vector<CDMRFanOutConf> fanOuts = m_conf.getDMRFanOuts();
+
+	for (std::vector<CDMRFanOutConf>::const_iterator it = fanOuts.begin(); it != fanOuts.end(); ++it) {
+		unsigned int id = it->m_id != 0U ? it->m_id : m_srcHS;
+		FLCO flco = it->m_pc ? FLCO_USER_USER : FLCO_GROUP;
+
+		LogMessage("DMR Fan Out Parameters");
+		LogMessage("    ID: %u", id);
+		LogMessage("    Address: %s", it->m_address.c_str());
+		LogMessage("    Port: %u", it->m_port);
+		LogMessage("    DstID: %s%u", it->m_pc ? "" : "TG ", it->m_dstId);
+		if (it->m_local > 0U)
+			LogMessage("    Local: %u", it->m_local);
+		else
+			LogMessage("    Local: random");
+
+		CDMRNetwork* network = new CDMRNetwork(it->m_address, it->m_port, it->m_local, id, it->m_password, false, VERSION, it->m_debug, false, true, HWT_MMDVM, m_conf.getDMRNetworkJitter());
+
+		if (!it->m_options.empty())
+			network->setOptions(it->m_options);
+
+		network->setConfig(m_callsign, m_conf.getRxFrequency(), m_conf.getTxFrequency(), m_conf.getPower(), m_colorcode, m_conf.getLatitude(), m_conf.getLongitude(), m_conf.getHeight(), m_conf.getLocation(), m_conf.getDescription(), m_conf.getURL());
+
+		bool ret = network->open();
+		if (!ret) {
+			delete network;
+			return false;
+		}
+
+		network->enable(true);
+
+		m_fanOutNetworks.push_back(network);
+
+		// Fed from the TS2 transcoder only, always to the configured destination
+		m_bridges[2U]->m_fanOut.add(network, it->m_dstId, flco);
+	}
+
+	return true;
+}
+
 void CYSF2DMR::writeXLXLink(unsigned int srcId, unsigned int dstId, CDMRNetwork* network)
 {
 	assert(network != NULL);
@@ -1299,20 +1270,8 @@ void CYSF2DMR::writeXLXLink(unsigned int srcId, unsigned int dstId, CDMRNetwork*
 
 	unsigned char buffer[DMR_FRAME_LENGTH_BYTES];
 
-	CDMRLC lc;
-	lc.setSrcId(srcId);
-	lc.setDstId(dstId);
-	lc.setFLCO(FLCO_USER_USER);
-
-	CDMRFullLC fullLC;
-	fullLC.encode(lc, buffer, DT_VOICE_LC_HEADER);
-
-	CDMRSlotType slotType;
-	slotType.setColorCode(XLX_COLOR_CODE);
-	slotType.setDataType(DT_VOICE_LC_HEADER);
-	slotType.getData(buffer);
-
-	CSync::addDMRDataSync(buffer, true);
+	const CDMRLCCacheEntry& lc = m_lcCache.find(FLCO_USER_USER, srcId, dstId, XLX_COLOR_CODE);
+	lc.getHeader(buffer, true);
 
 	data.setData(buffer);
 
@@ -1323,10 +1282,7 @@ void CYSF2DMR::writeXLXLink(unsigned int srcId, unsigned int dstId, CDMRNetwork*
 
 	data.setDataType(DT_TERMINATOR_WITH_LC);
 
-	fullLC.encode(lc, buffer, DT_TERMINATOR_WITH_LC);
-
-	slotType.setDataType(DT_TERMINATOR_WITH_LC);
-	slotType.getData(buffer);
+	lc.getTerminator(buffer, true);
 
 	data.setData(buffer);
 
@@ -1336,3 +1292,662 @@ void CYSF2DMR::writeXLXLink(unsigned int srcId, unsigned int dstId, CDMRNetwork*
 	}
 }
 
+// The slot 1 endpoint is a fixed bridge, it has no Wires-X, DTMF or GPS handling
+void CYSF2DMR::readSlotYSF(CBridgeSlot& bridge)
+{
+	for (;;) {
+		unsigned char ysfBuffer[YSF_FICH_BATCH][256U];
+		const unsigned char* fichData[YSF_FICH_BATCH];
+		unsigned int nFrames = 0U;
+
+		while ((nFrames < YSF_FICH_BATCH) && (bridge.m_ysfNetwork->read(ysfBuffer[nFrames]) > 0U)) {
+			fichData[nFrames] = ysfBuffer[nFrames] + 35U;
+			nFrames++;
+		}
+
+		if (nFrames == 0U)
+			break;
+
+		CYSFFICH fichs[YSF_FICH_BATCH];
+		bool fichValid[YSF_FICH_BATCH];
+		CYSFFICH::decode(fichData, fichs, fichValid, nFrames);
+
+		for (unsigned int k = 0U; k < nFrames; k++) {
+			unsigned char* buffer = ysfBuffer[k];
+
+			if (!fichValid[k] || ::memcmp(buffer, "YSFD", 4U) != 0 || fichs[k].getDT() != YSF_DT_VD_MODE2)
+				continue;
+
+			unsigned char fi = fichs[k].getFI();
+
+			if (fi == YSF_FI_HEADER) {
+				char ysfSrc[YSF_CALLSIGN_LENGTH + 1U];
+				char ysfDst[YSF_CALLSIGN_LENGTH + 1U];
+				if (CYSFPayload::readHeaderData(buffer + 35U, ysfDst, ysfSrc)) {
+					LogMessage("Received YSF Header on slot %u: Src: %s Dst: %s", bridge.m_slotNo, ysfSrc, ysfDst);
+					bridge.m_srcId = findYSFID(ysfSrc, false);
+					writeYSFQueue(bridge, TAG_HEADER, bridge.m_srcId, bridge.m_dstId, bridge.m_flco, NULL);
+					heardYSFStart(bridge, ysfSrc, bridge.m_srcId, bridge.m_dstId, bridge.m_flco);
+					bridge.m_ysfFrames = 0U;
+				}
+			} else if (fi == YSF_FI_TERMINATOR) {
+				LogMessage("YSF received end of voice transmission on slot %u, %.1f seconds", bridge.m_slotNo, float(bridge.m_ysfFrames) / 10.0F);
+				writeYSFQueue(bridge, TAG_EOT, bridge.m_srcId, bridge.m_dstId, bridge.m_flco, NULL);
+				heardYSFEnd(bridge, bridge.m_ysfFrames);
+				bridge.m_ysfFrames = 0U;
+			} else if (fi == YSF_FI_COMMUNICATIONS) {
+				writeYSFQueue(bridge, TAG_DATA, bridge.m_srcId, bridge.m_dstId, bridge.m_flco, buffer + 35U);
+				heardYSFData(bridge, fichs[k].getFN(), fichs[k].getFT());
+				bridge.m_ysfFrames++;
+			}
+		}
+	}
+}
+
+void CYSF2DMR::dmrIngress()
+{
+	CStopWatch stopWatch;
+	stopWatch.start();
+
+	for (; end == 0;) {
+		CDMRData tx_dmrdata;
+		unsigned int ms = stopWatch.elapsed();
+		stopWatch.start();
+
+		m_dmrNetwork->clock(ms);
+
+		while (m_dmrNetwork->read(tx_dmrdata) > 0U) {
+			unsigned int SrcId = tx_dmrdata.getSrcId();
+			unsigned int DstId = tx_dmrdata.getDstId();
+			
+			FLCO netflco = tx_dmrdata.getFLCO();
+			unsigned char DataType = tx_dmrdata.getDataType();
+
+			// Overlapping streams from the master each get their own state, only one per slot reaches YSF
+			CBridgeSlot* bridge = m_bridges[tx_dmrdata.getSlotNo()];
+			if (bridge == NULL)
+				continue;
+
+			CDMRStreams& streams = bridge->m_streams;
+
+			if (!tx_dmrdata.isMissing()) {
+				CDMRStream* stream = streams.open(tx_dmrdata.getStreamId(), tx_dmrdata.getSlotNo());
+				if (stream == NULL)
+					continue;
+
+				stream->m_watchdog.start();
+
+				if(DataType == DT_TERMINATOR_WITH_LC) {
+					LogMessage("DMR received end of voice transmission, %.1f seconds", float(stream->m_frames) / 16.667F);
+
+					if (SrcId == 4000 && bridge->m_slotNo == 2U)
+						m_unlinkReceived = true;
+
+					endDMRStream(streams, stream);
+					continue;
+				}
+
+				if(DataType == DT_VOICE_LC_HEADER || DataType == DT_VOICE_SYNC || DataType == DT_VOICE) {
+					if (!stream->m_info) {
+						stream->m_srcId = SrcId;
+						stream->m_dstId = DstId;
+						stream->m_flco  = netflco;
+						identifyDMRStream(*stream);
+					} else if (!stream->m_located) {
+						locateDMRStream(*stream);
+					}
+
+					CDMRStream* preempted = NULL;
+					bool active = streams.isActive(stream);
+
+					if (!active && streams.claim(stream, preempted)) {
+						if (preempted != NULL) {
+							LogMessage("DMR audio from %s taken over by %s", preempted->m_netSrc.c_str(), stream->m_netSrc.c_str());
+							stopDMRStream(*preempted);
+						}
+
+						startDMRStream(*stream);
+						active = true;
+					}
+
+					if(DataType != DT_VOICE_LC_HEADER) {
+						if (active && stream->m_leader == 0U) {
+							unsigned char dmr_frame[50];
+							tx_dmrdata.getData(dmr_frame);
+							writeDMRQueue(*stream, TAG_DATA, dmr_frame); // Add DMR frame for YSF conversion
+						}
+
+						stream->m_frames++;
+						stream->m_errors += tx_dmrdata.getBER();
+						stream->m_bits   += 141U;
+					}
+				}
+			}
+			else {
+				// Repeated by the delay buffer, so only a stream we already know
+				CDMRStream* stream = streams.find(tx_dmrdata.getStreamId());
+
+				if((DataType == DT_VOICE_SYNC || DataType == DT_VOICE) && stream != NULL) {
+					stream->m_lost++;
+
+					if (streams.isActive(stream) && stream->m_leader == 0U) {
+						unsigned char dmr_frame[50];
+						tx_dmrdata.getData(dmr_frame);
+						writeDMRQueue(*stream, TAG_DATA, dmr_frame); // Add DMR frame for YSF conversion
+						stream->m_frames++;
+					}
+				}
+			}
+		}
+
+		// The fan out masters only receive from us, whatever they send is dropped
+		for (std::vector<CDMRNetwork*>::iterator it = m_fanOutNetworks.begin(); it != m_fanOutNetworks.end(); ++it) {
+			(*it)->clock(ms);
+			while ((*it)->read(tx_dmrdata) > 0U)
+				;
+		}
+
+		for (unsigned int slotNo = 1U; slotNo <= 2U; slotNo++) {
+			if (m_bridges[slotNo] == NULL)
+				continue;
+
+			CDMRStreams& streams = m_bridges[slotNo]->m_streams;
+			streams.clock(ms);
+
+			CDMRStream* expired;
+			while ((expired = streams.getExpired()) != NULL) {
+				LogDebug("Network watchdog has expired on slot %u, %.1f seconds", slotNo, float(expired->m_frames) / 16.667F);
+				endDMRStream(streams, expired);
+			}
+		}
+
+		if (ms < 5U)
+			CThread::sleep(5U);
+	}
+}
+
+void CYSF2DMR::identifyDMRStream(CDMRStream& stream)
+{
+	// DT1 & DT2 without GPS info
+	::memcpy(stream.m_gps, dt1_temp, 10U);
+	::memcpy(stream.m_gps + 10U, dt2_temp, 10U);
+
+	if (stream.m_srcId == 9990U)
+		stream.m_netSrc = "PARROT";
+	else if (stream.m_srcId == 9U)
+		stream.m_netSrc = "LOCAL";
+	else if (stream.m_srcId == 4000U)
+		stream.m_netSrc = "UNLINK";
+	else
+		stream.m_netSrc = m_lookup->findCS(stream.m_srcId);
+
+	stream.m_netDst = (stream.m_flco == FLCO_GROUP ? "TG " : "") + m_lookup->findCS(stream.m_dstId);
+
+	LogMessage("DMR audio received from %s to %s", stream.m_netSrc.c_str(), stream.m_netDst.c_str());
+
+	heardDMR(LHE_START, stream);
+
+	stream.m_located = !m_lookup->exists(stream.m_srcId) || (m_APRS == NULL);
+	if (!stream.m_located)
+		locateDMRStream(stream);
+
+	stream.m_netSrc.resize(YSF_CALLSIGN_LENGTH, ' ');
+	stream.m_netDst.resize(YSF_CALLSIGN_LENGTH, ' ');
+
+	stream.m_info = true;
+}
+
+// Called again on later frames until a position turns up, so that a lookup
+// finishing after the header still reaches the rest of the stream
+void CYSF2DMR::locateDMRStream(CDMRStream& stream)
+{
+	std::string cs = stream.m_netSrc;
+	cs.erase(cs.find_last_not_of(' ') + 1U);
+
+	int lat, lon;
+	if (m_APRS->findCall(cs, &lat, &lon)) {
+		LogMessage("GPS Position of %s Lat: %0.3f, Lon: %0.3f", cs.c_str(), (float)lat / 1000.0, (float)lon / 1000.0);
+		m_APRS->formatGPS(stream.m_gps, lat, lon);
+		stream.m_located = true;
+	}
+}
+
+// A stream that another slot is already transcoding, the same talker on the
+// same destination, is not transcoded again but rides along on that slot
+void CYSF2DMR::startDMRStream(CDMRStream& stream)
+{
+	for (unsigned int slotNo = 1U; slotNo <= 2U; slotNo++) {
+		if (slotNo == stream.m_slotNo || m_bridges[slotNo] == NULL)
+			continue;
+
+		CDMRStream* leader = m_bridges[slotNo]->m_streams.getActive();
+		if (leader == NULL || leader->m_leader != 0U)
+			continue;
+
+		if (leader->m_srcId == stream.m_srcId && leader->m_dstId == stream.m_dstId && leader->m_flco == stream.m_flco) {
+			LogMessage("DMR audio on slot %u shared with slot %u", stream.m_slotNo, slotNo);
+			leader->m_followers |= 1U << stream.m_slotNo;
+			stream.m_leader = slotNo;
+			return;
+		}
+	}
+
+	writeDMRQueue(stream, TAG_HEADER, NULL);
+}
+
+void CYSF2DMR::stopDMRStream(CDMRStream& stream)
+{
+	if (stream.m_leader == 0U) {
+		// The followers get their end of transmission along with ours
+		writeDMRQueue(stream, TAG_EOT, NULL);
+
+		// and carry on with their own transcoders, if their talker has not stopped
+		for (unsigned int slotNo = 1U; slotNo <= 2U; slotNo++) {
+			if ((stream.m_followers & (1U << slotNo)) == 0U || m_bridges[slotNo] == NULL)
+				continue;
+
+			CDMRStream* follower = m_bridges[slotNo]->m_streams.getActive();
+			if (follower == NULL || follower->m_leader != stream.m_slotNo)
+				continue;
+
+			LogMessage("DMR audio on slot %u no longer shared with slot %u", slotNo, stream.m_slotNo);
+			follower->m_leader = 0U;
+			writeDMRQueue(*follower, TAG_HEADER, NULL);
+		}
+
+		stream.m_followers = 0U;
+		return;
+	}
+
+	CDMRStream* leader = m_bridges[stream.m_leader]->m_streams.getActive();
+	if (leader != NULL)
+		leader->m_followers &= ~(1U << stream.m_slotNo);
+
+	stream.m_leader = 0U;
+}
+
+void CYSF2DMR::endDMRStream(CDMRStreams& streams, CDMRStream* stream)
+{
+	if (streams.isActive(stream))
+		stopDMRStream(*stream);
+
+	if (stream->m_info)
+		heardDMR(LHE_END, *stream);
+
+	unsigned int slotNo   = stream->m_slotNo;
+	unsigned int streamId = stream->m_streamId;
+
+	streams.close(stream);
+
+	// Every stream has its own delay buffer, the slot is only reset once none is left
+	if (streams.hasSlot(slotNo))
+		m_dmrNetwork->release(streamId);
+	else
+		m_dmrNetwork->reset(slotNo);
+}
+
+void CYSF2DMR::heardYSFStart(CBridgeSlot& bridge, const std::string& src, unsigned int srcId, unsigned int dstId, FLCO flco)
+{
+	if (m_lastHeard == NULL)
+		return;
+
+	CLastHeardEvent& call = bridge.m_ysfCall;
+	::memset(&call, 0x00U, sizeof(CLastHeardEvent));
+
+	call.m_event     = LHE_START;
+	call.m_direction = LHD_YSF_TO_DMR;
+	call.m_slotNo    = bridge.m_slotNo;
+	call.m_srcId     = srcId;
+	call.m_dstId     = dstId;
+	call.m_group     = flco == FLCO_GROUP ? 1U : 0U;
+	CLastHeard::setCallsign(call.m_srcCallsign, src);
+	CLastHeard::setCallsign(call.m_dstCallsign, (flco == FLCO_GROUP ? "TG " : "") + m_lookup->findCS(dstId));
+
+	m_lastHeard->write(call);
+
+	bridge.m_ysfFN = 0U;
+}
+
+// YSF carries no BER over the network, gaps in the FICH frame numbers are
+// all there is to show for lost frames
+void CYSF2DMR::heardYSFData(CBridgeSlot& bridge, unsigned char fn, unsigned char ft)
+{
+	if (m_lastHeard == NULL || bridge.m_ysfCall.m_event != LHE_START)
+		return;
+
+	unsigned int frames = ft + 1U;
+
+	bridge.m_ysfCall.m_lost += (fn + frames - bridge.m_ysfFN % frames) % frames;
+	bridge.m_ysfFN = (fn + 1U) % frames;
+}
+
+void CYSF2DMR::heardYSFEnd(CBridgeSlot& bridge, unsigned int frames)
+{
+	if (m_lastHeard == NULL || bridge.m_ysfCall.m_event != LHE_START)
+		return;
+
+	CLastHeardEvent& call = bridge.m_ysfCall;
+
+	call.m_event    = LHE_END;
+	call.m_duration = frames * 100U;
+	call.m_frames   = frames;
+
+	m_lastHeard->write(call);
+}
+
+void CYSF2DMR::heardDMR(LASTHEARD_EVENT type, const CDMRStream& stream)
+{
+	if (m_lastHeard == NULL)
+		return;
+
+	CLastHeardEvent event;
+	::memset(&event, 0x00U, sizeof(CLastHeardEvent));
+
+	event.m_event     = type;
+	event.m_direction = LHD_DMR_TO_YSF;
+	event.m_slotNo    = stream.m_slotNo;
+	event.m_srcId     = stream.m_srcId;
+	event.m_dstId     = stream.m_dstId;
+	event.m_group     = stream.m_flco == FLCO_GROUP ? 1U : 0U;
+	CLastHeard::setCallsign(event.m_srcCallsign, stream.m_netSrc);
+	CLastHeard::setCallsign(event.m_dstCallsign, stream.m_netDst);
+
+	if (type == LHE_END) {
+		event.m_duration = stream.m_frames * 60U;
+		event.m_frames   = stream.m_frames;
+		event.m_lost     = stream.m_lost;
+		if (stream.m_bits > 0U)
+			event.m_ber = (unsigned int)((uint64_t(stream.m_errors) * 10000U) / stream.m_bits);
+	}
+
+	m_lastHeard->write(event);
+}
+
+void CYSF2DMR::ysf2dmrStage(CBridgeSlot* bridge)
+{
+	CModeConv conv;
+	CYSFVoiceFrame frame;
+
+	unsigned char dmrFrame[50U];
+	::memset(dmrFrame, 0U, 50U);
+
+	unsigned int srcId = bridge->m_slotNo == 2U ? m_srcid : bridge->m_srcId;
+	unsigned int dstId = bridge->m_slotNo == 2U ? m_dstid : bridge->m_dstId;
+	FLCO flco          = bridge->m_slotNo == 2U ? m_dmrflco : bridge->m_flco;
+
+	CFramePacer pacer(DMR_FRAME_PER, m_conf.getTranscoderLatency() / DMR_FRAME_PER);
+
+	CStopWatch stopWatch;
+	stopWatch.start();
+
+	for (; end == 0;) {
+		unsigned int ms = stopWatch.elapsed();
+		stopWatch.start();
+
+		while (bridge->m_ysfQueue.hasData()) {
+			bridge->m_ysfQueue.getData(&frame, 1U);
+
+			srcId = frame.m_srcId;
+			dstId = frame.m_dstId;
+			flco  = frame.m_flco;
+
+			if (frame.m_tag == TAG_HEADER)
+				conv.putYSFHeader();
+			else if (frame.m_tag == TAG_EOT)
+				conv.putYSFEOT();
+			else
+				conv.putYSF(frame.m_data);
+		}
+
+		if (pacer.isDue(conv.getDMRFrames())) {
+			unsigned int dmrFrameType = conv.getDMR(dmrFrame);
+
+			// Transcoded once, then wrapped for every master the bridge feeds
+			if (dmrFrameType == TAG_HEADER) {
+				bridge->m_fanOut.writeHeader(srcId, dstId, flco);
+				pacer.sent();
+			} else if (dmrFrameType == TAG_EOT) {
+				bridge->m_fanOut.writeTerminator(srcId, dstId, flco);
+				pacer.sent();
+			} else if (dmrFrameType == TAG_DATA) {
+				//CUtils::dump(1U, "DMR data:", dmrFrame, 33U);
+				bridge->m_fanOut.writeData(srcId, dstId, flco, dmrFrame);
+				pacer.sent();
+			}
+		}
+
+		if (ms < 5U)
+			CThread::sleep(5U);
+	}
+}
+
+void CYSF2DMR::dmr2ysfStage(CBridgeSlot* bridge)
+{
+	CModeConv conv;
+	CDMRVoiceFrame frame;
+
+	unsigned char ysfFrame[200U];
+	::memset(ysfFrame, 0U, 200U);
+
+	unsigned char netSrc[YSF_CALLSIGN_LENGTH];
+	unsigned char netDst[YSF_CALLSIGN_LENGTH];
+	unsigned char gps[20U];
+	::memset(netSrc, ' ', YSF_CALLSIGN_LENGTH);
+	::memset(netDst, ' ', YSF_CALLSIGN_LENGTH);
+	::memcpy(gps, dt1_temp, 10U);
+	::memcpy(gps + 10U, dt2_temp, 10U);
+
+	unsigned char ysf_cnt = 0U;
+
+	// The slots fed by this stage, as requested by the ingress and as being sent
+	unsigned int wanted  = 1U << bridge->m_slotNo;
+	unsigned int targets = wanted;
+
+	CFramePacer pacer(YSF_FRAME_PER, m_conf.getTranscoderLatency() / YSF_FRAME_PER);
+
+	CStopWatch stopWatch;
+	stopWatch.start();
+
+	for (; end == 0;) {
+		unsigned int ms = stopWatch.elapsed();
+		stopWatch.start();
+
+		while (bridge->m_dmrQueue.hasData()) {
+			bridge->m_dmrQueue.getData(&frame, 1U);
+
+			::memcpy(netSrc, frame.m_netSrc, YSF_CALLSIGN_LENGTH);
+			::memcpy(netDst, frame.m_netDst, YSF_CALLSIGN_LENGTH);
+			::memcpy(gps, frame.m_gps, 20U);
+			wanted = frame.m_bridges;
+
+			if (frame.m_tag == TAG_HEADER)
+				conv.putDMRHeader();
+			else if (frame.m_tag == TAG_EOT)
+				conv.putDMREOT();
+			else
+				conv.putDMR(frame.m_data);
+		}
+
+		if (pacer.isDue(conv.getYSFFrames())) {
+			unsigned int ysfFrameType = conv.getYSF(ysfFrame + 35U);
+
+			if(ysfFrameType == TAG_HEADER) {
+				ysf_cnt = 0U;
+				targets = wanted;
+
+				buildYSFHeader(ysfFrame, YSF_FI_HEADER, 0U, netSrc);
+				writeYSF(targets, ysfFrame);
+				
+				ysf_cnt++;
+				pacer.sent();
+			}
+			else if (ysfFrameType == TAG_EOT) {
+				buildYSFHeader(ysfFrame, YSF_FI_TERMINATOR, ysf_cnt, netSrc);
+				writeYSF(targets, ysfFrame);
+			}
+			else if (ysfFrameType == TAG_DATA) {
+				// Slots joining or leaving part way through get a header or terminator of their own
+				if (wanted != targets) {
+					unsigned char control[200U];
+					::memset(control, 0U, 200U);
+
+					if ((wanted & ~targets) != 0U) {
+						buildYSFHeader(control, YSF_FI_HEADER, 0U, netSrc);
+						writeYSF(wanted & ~targets, control);
+					}
+
+					if ((targets & ~wanted) != 0U) {
+						buildYSFHeader(control, YSF_FI_TERMINATOR, ysf_cnt, netSrc);
+						writeYSF(targets & ~wanted, control);
+					}
+
+					targets = wanted;
+				}
+
+				CYSFFICH fich;
+				CYSFPayload ysfPayload;
+
+				unsigned int fn = (ysf_cnt - 1U) % 8U;
+
+				::memcpy(ysfFrame + 0U, "YSFD", 4U);
+				::memcpy(ysfFrame + 14U, netSrc, YSF_CALLSIGN_LENGTH);
+				::memcpy(ysfFrame + 24U, "ALL       ", YSF_CALLSIGN_LENGTH);
+
+				// Add the YSF Sync
+				CSync::addYSFSync(ysfFrame + 35U);
+
+				switch (fn) {
+					case 0:
+						ysfPayload.writeVDMode2Data(ysfFrame + 35U, (const unsigned char*)"**********");
+						break;
+					case 1:
+						ysfPayload.writeVDMode2Data(ysfFrame + 35U, netSrc);
+						break;
+					case 2:
+						ysfPayload.writeVDMode2Data(ysfFrame + 35U, netDst);
+						break;
+					case 6:
+						ysfPayload.writeVDMode2Data(ysfFrame + 35U, gps);
+						break;
+					case 7:
+						ysfPayload.writeVDMode2Data(ysfFrame + 35U, gps+10U);
+						break;
+					default:
+						ysfPayload.writeVDMode2Data(ysfFrame + 35U, (const unsigned char*)"          ");
+				}
+				
+				// Set the FICH
+				fich.setFI(YSF_FI_COMMUNICATIONS);
+				fich.setCS(2U);
+				fich.setFN(fn);
+				fich.setFT(7U);
+				fich.setDev(0U);
+				fich.setMR(YSF_MR_BUSY);
+				fich.setDT(YSF_DT_VD_MODE2);
+				fich.setSQL(0U);
+				fich.setSQ(0U);
+				fich.encode(ysfFrame + 35U);
+
+				// Net frame counter
+				ysfFrame[34U] = (ysf_cnt & 0x7FU) << 1;
+
+				// Send data to MMDVMHost
+				writeYSF(targets, ysfFrame);
+				
+				ysf_cnt++;
+				pacer.sent();
+			}
+		}
+
+		if (ms < 5U)
+			CThread::sleep(5U);
+	}
+}
+
+// The header and terminator only differ in their FI and frame counter
+void CYSF2DMR::buildYSFHeader(unsigned char* data, unsigned char fi, unsigned char counter, const unsigned char* netSrc) const
+{
+	::memcpy(data + 0U, "YSFD", 4U);
+	::memcpy(data + 14U, netSrc, YSF_CALLSIGN_LENGTH);
+	::memcpy(data + 24U, "ALL       ", YSF_CALLSIGN_LENGTH);
+	data[34U] = counter; // Net frame counter
+
+	CSync::addYSFSync(data + 35U);
+
+	// Set the FICH
+	CYSFFICH fich;
+	fich.setFI(fi);
+	fich.setCS(2U);
+	fich.setFN(0U);
+	fich.setFT(7U);
+	fich.setDev(0U);
+	fich.setMR(2U);
+	fich.setDT(YSF_DT_VD_MODE2);
+	fich.setSQL(0U);
+	fich.setSQ(0U);
+	fich.encode(data + 35U);
+
+	unsigned char csd1[20U], csd2[20U];
+	memset(csd1, '*', YSF_CALLSIGN_LENGTH);
+	memcpy(csd1 + YSF_CALLSIGN_LENGTH, netSrc, YSF_CALLSIGN_LENGTH);
+	memset(csd2, ' ', YSF_CALLSIGN_LENGTH + YSF_CALLSIGN_LENGTH);
+
+	CYSFPayload payload;
+	payload.writeHeader(data + 35U, csd1, csd2);
+}
+
+// The frame is built once, only the gateway callsign differs per endpoint
+void CYSF2DMR::writeYSF(unsigned int bridges, unsigned char* data)
+{
+	for (unsigned int slotNo = 1U; slotNo <= 2U; slotNo++) {
+		if ((bridges & (1U << slotNo)) == 0U || m_bridges[slotNo] == NULL)
+			continue;
+
+		CYSFNetwork* network = m_bridges[slotNo]->m_ysfNetwork;
+
+		::memcpy(data + 4U, network->getCallsign().c_str(), YSF_CALLSIGN_LENGTH);
+		network->write(data);
+	}
+}
+
+void CYSF2DMR::writeYSFQueue(CBridgeSlot& bridge, unsigned char tag, unsigned int srcId, unsigned int dstId, FLCO flco, const unsigned char* data)
+{
+	CYSFVoiceFrame frame;
+
+	frame.m_tag   = tag;
+	frame.m_srcId = srcId;
+	frame.m_dstId = dstId;
+	frame.m_flco  = flco;
+
+	if (data != NULL)
+		::memcpy(frame.m_data, data, YSF_FRAME_LENGTH_BYTES);
+	else
+		::memset(frame.m_data, 0x00U, YSF_FRAME_LENGTH_BYTES);
+
+	bridge.m_ysfQueue.addData(&frame, 1U);
+}
+
+void CYSF2DMR::writeDMRQueue(const CDMRStream& stream, unsigned char tag, const unsigned char* data)
+{
+	CDMRVoiceFrame frame;
+
+	frame.m_tag     = tag;
+	frame.m_bridges = (1U << stream.m_slotNo) | stream.m_followers;
+
+	unsigned int length = (unsigned int)stream.m_netSrc.length();
+	::memset(frame.m_netSrc, ' ', YSF_CALLSIGN_LENGTH);
+	::memcpy(frame.m_netSrc, stream.m_netSrc.c_str(), length < YSF_CALLSIGN_LENGTH ? length : YSF_CALLSIGN_LENGTH);
+
+	length = (unsigned int)stream.m_netDst.length();
+	::memset(frame.m_netDst, ' ', YSF_CALLSIGN_LENGTH);
+	::memcpy(frame.m_netDst, stream.m_netDst.c_str(), length < YSF_CALLSIGN_LENGTH ? length : YSF_CALLSIGN_LENGTH);
+
+	::memcpy(frame.m_gps, stream.m_gps, 20U);
+
+	if (data != NULL)
+		::memcpy(frame.m_data, data, DMR_FRAME_LENGTH_BYTES);
+	else
+		::memset(frame.m_data, 0x00U, DMR_FRAME_LENGTH_BYTES);
+
+	m_bridges[stream.m_slotNo]->m_dmrQueue.addData(&frame, 1U);
+}
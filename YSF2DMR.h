@@ -28,6 +28,7 @@
 #include "DMRLC.h"
 #include "DMRFullLC.h"
 #include "DMREMB.h"
+#include "DMRLCCache.h"
 #include "DMRLookup.h"
 #include "UDPSocket.h"
 #include "StopWatch.h"
@@ -35,6 +36,7 @@
 #include "YSFPayload.h"
 #include "YSFNetwork.h"
 #include "YSFFICH.h"
+#include "YSFConvolution.h"
 #include "Reflectors.h"
 #include "Thread.h"
 #include "Timer.h"
@@ -47,14 +49,138 @@
 #include "WiresX.h"
 #include "CRC.h"
 #include "APRSReader.h"
+#include "SPSCRingBuffer.h"
+#include "FramePacer.h"
+#include "DMRStreams.h"
+#include "DMRFanOut.h"
+#include "Resolver.h"
+#include "TGSequencer.h"
+#include "LastHeard.h"
+#include "FileWatcher.h"
 
 #include <string>
+#include <cstring>
+#include <atomic>
+#include <vector>
 
-enum TG_STATUS {
-	NONE,
-	WAITING_UNLINK,
-	SEND_REPLY,
-	SEND_PTT
+// Voice frame handed from the YSF ingress to the YSF->DMR stage
+class CYSFVoiceFrame {
+public:
+	unsigned char m_tag;
+	unsigned int  m_srcId;
+	unsigned int  m_dstId;
+	FLCO          m_flco;
+	unsigned char m_data[YSF_FRAME_LENGTH_BYTES];
+};
+
+// Voice frame handed from the DMR ingress to the DMR->YSF stage, with the
+// slots whose YSF endpoints are to receive the result as a bit mask
+class CDMRVoiceFrame {
+public:
+	unsigned char m_tag;
+	unsigned char m_bridges;
+	unsigned char m_netSrc[YSF_CALLSIGN_LENGTH];
+	unsigned char m_netDst[YSF_CALLSIGN_LENGTH];
+	unsigned char m_gps[20U];
+	unsigned char m_data[DMR_FRAME_LENGTH_BYTES];
+};
+
+// The YSF stream coming in on a slot, with the work on its source done when
+// the stream starts rather than for every frame
+class CYSFIngress {
+public:
+	CYSFIngress() :
+	m_active(false),
+	m_counter(0U),
+	m_srcId(0U)
+	{
+		::memset(m_source, 0x00U, YSF_CALLSIGN_LENGTH);
+		::memset(m_callsign, 0x00U, YSF_CALLSIGN_LENGTH + 1U);
+	}
+
+	bool          m_active;		// Cleared at the end of a stream
+	unsigned char m_source[YSF_CALLSIGN_LENGTH];	// As sent, a new source starts a new stream
+	unsigned char m_counter;	// The last network frame counter
+	char          m_callsign[YSF_CALLSIGN_LENGTH + 1U];	// Trimmed on the right
+	unsigned int  m_srcId;		// 0 until looked up
+};
+
+// One YSF endpoint bridged to one DMR timeslot, with the queues feeding its
+// two transcoding stages, the DMR streams received on its slot and the
+// masters its transcoded audio is sent to
+class CBridgeSlot {
+public:
+	CBridgeSlot(unsigned int slotNo, CYSFNetwork* network, unsigned char colorCode, DMR_ARBITRATION arbitration, unsigned int priorityTG, unsigned int hangTime) :
+	m_slotNo(slotNo),
+	m_ysfNetwork(network),
+	m_ysfQueue(100U, "YSF Voice Queue"),
+	m_dmrQueue(200U, "DMR Voice Queue"),
+	m_streams(8U, arbitration, priorityTG, hangTime),
+	m_fanOut(slotNo, colorCode),
+	m_srcId(0U),
+	m_dstId(0U),
+	m_flco(FLCO_GROUP),
+	m_ysfFrames(0U),
+	m_ysfFN(0U),
+	m_ingress()
+	{
+		::memset(&m_ysfCall, 0x00U, sizeof(CLastHeardEvent));
+	}
+
+	unsigned int                    m_slotNo;
+	CYSFNetwork*                    m_ysfNetwork;
+	CSPSCRingBuffer<CYSFVoiceFrame> m_ysfQueue;
+	CSPSCRingBuffer<CDMRVoiceFrame> m_dmrQueue;
+	CDMRStreams                     m_streams;
+	CDMRFanOut                      m_fanOut;
+	unsigned int                    m_srcId;
+	unsigned int                    m_dstId;
+	FLCO                            m_flco;
+	unsigned int                    m_ysfFrames;
+	CLastHeardEvent                 m_ysfCall;		// The YSF call being heard, for the last heard feed
+	unsigned int                    m_ysfFN;		// The frame number expected next
+	CYSFIngress                     m_ingress;
+};
+
+class CYSF2DMR;
+
+typedef void (CYSF2DMR::*STAGE_ENTRY)();
+typedef void (CYSF2DMR::*BRIDGE_ENTRY)(CBridgeSlot* bridge);
+
+class CStageThread : public CThread
+{
+public:
+	CStageThread(CYSF2DMR* owner, STAGE_ENTRY stage) :
+	CThread(),
+	m_owner(owner),
+	m_stage(stage),
+	m_bridgeStage(NULL),
+	m_bridge(NULL)
+	{
+	}
+
+	CStageThread(CYSF2DMR* owner, BRIDGE_ENTRY stage, CBridgeSlot* bridge) :
+	CThread(),
+	m_owner(owner),
+	m_stage(NULL),
+	m_bridgeStage(stage),
+	m_bridge(bridge)
+	{
+	}
+
+	virtual void entry()
+	{
+		if (m_bridge != NULL)
+			(m_owner->*m_bridgeStage)(m_bridge);
+		else
+			(m_owner->*m_stage)();
+	}
+
+private:
+	CYSF2DMR*    m_owner;
+	STAGE_ENTRY  m_stage;
+	BRIDGE_ENTRY m_bridgeStage;
+	CBridgeSlot* m_bridge;
 };
 
 class CYSF2DMR
@@ -68,12 +194,15 @@ public:
 private:
 	std::string      m_callsign;
 	std::string      m_suffix;
+	std::string      m_configFile;
 	CConf            m_conf;
 	CWiresX*         m_wiresX;
 	CDMRNetwork*     m_dmrNetwork;
 	CYSFNetwork*     m_ysfNetwork;
 	CDMRLookup*      m_lookup;
-	CModeConv        m_conv;
+	CBridgeSlot*     m_bridges[3U];
+	std::vector<CDMRNetwork*> m_fanOutNetworks;
+	std::atomic<bool> m_unlinkReceived;
 	unsigned int     m_colorcode;
 	unsigned int     m_srcHS;
 	unsigned int     m_srcid;
@@ -82,21 +211,17 @@ private:
 	unsigned int     m_ptt_dstid;
 	bool             m_ptt_pc;
 	bool             m_dmrpc;
-	std::string      m_netSrc;
-	std::string      m_netDst;
 	std::string      m_ysfSrc;
-	unsigned char    m_dmrLastDT;
-	unsigned char    m_ysfFrame[200U];
 	unsigned char    m_dmrFrame[50U];
 	CGPS*            m_gps;
 	CDTMF*           m_dtmf;
 	CAPRSReader*     m_APRS;
-	unsigned int     m_dmrFrames;
+	CLastHeard*      m_lastHeard;
+	CFileWatcher*    m_watcher;
 	unsigned int     m_ysfFrames;
-	CDMREmbeddedData m_EmbeddedLC;
+	CDMRLCCache      m_lcCache;
 	std::string      m_TGList;
 	FLCO             m_dmrflco;
-	bool             m_dmrinfo;
 	unsigned int     m_idUnlink;
 	FLCO             m_flcoUnlink;
 	bool             m_enableWiresX;
@@ -105,12 +230,34 @@ private:
 	CReflectors*     m_xlxReflectors;
 	unsigned int     m_xlxrefl;
 
+	void prepareRealTime();
+	void reloadConf();
 	bool createDMRNetwork();
+	bool createFanOutNetworks();
 	void createGPS();
 	void SendDummyDMR(unsigned int srcid, unsigned int dstid, FLCO dmr_flco);
-	unsigned int findYSFID(std::string cs, bool showdst);
-	std::string getSrcYSF(const unsigned char* source);
+	unsigned int findYSFID(const char* cs, bool showdst);
+	bool ysfIngress(CBridgeSlot& bridge, const unsigned char* buffer, unsigned char fi);
+	unsigned int ingressID(CYSFIngress& ingress);
 	void writeXLXLink(unsigned int srcId, unsigned int dstId, CDMRNetwork* network);
+
+	void dmrIngress();
+	void ysf2dmrStage(CBridgeSlot* bridge);
+	void dmr2ysfStage(CBridgeSlot* bridge);
+	void readSlotYSF(CBridgeSlot& bridge);
+	void writeYSFQueue(CBridgeSlot& bridge, unsigned char tag, unsigned int srcId, unsigned int dstId, FLCO flco, const unsigned char* data);
+	void writeDMRQueue(const CDMRStream& stream, unsigned char tag, const unsigned char* data);
+	void identifyDMRStream(CDMRStream& stream);
+	void locateDMRStream(CDMRStream& stream);
+	void startDMRStream(CDMRStream& stream);
+	void stopDMRStream(CDMRStream& stream);
+	void endDMRStream(CDMRStreams& streams, CDMRStream* stream);
+	void heardYSFStart(CBridgeSlot& bridge, const std::string& src, unsigned int srcId, unsigned int dstId, FLCO flco);
+	void heardYSFData(CBridgeSlot& bridge, unsigned char fn, unsigned char ft);
+	void heardYSFEnd(CBridgeSlot& bridge, unsigned int frames);
+	void heardDMR(LASTHEARD_EVENT type, const CDMRStream& stream);
+	void buildYSFHeader(unsigned char* data, unsigned char fi, unsigned char counter, const unsigned char* netSrc) const;
+	void writeYSF(unsigned int bridges, unsigned char* data);
 };
 
 #endif
@@ -22,43 +22,175 @@
 #include <cassert>
 #include <cstring>
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define	USE_SSE2
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define	USE_NEON
+#include <arm_neon.h>
+#if !defined(__aarch64__) && defined(__linux__)
+#include <sys/auxv.h>
+#include <asm/hwcap.h>
+#endif
+#endif
+
 const unsigned char BIT_MASK_TABLE[] = {0x80U, 0x40U, 0x20U, 0x10U, 0x08U, 0x04U, 0x02U, 0x01U};
 
 #define WRITE_BIT1(p,i,b) p[(i)>>3] = (b) ? (p[(i)>>3] | BIT_MASK_TABLE[(i)&7]) : (p[(i)>>3] & ~BIT_MASK_TABLE[(i)&7])
 #define READ_BIT1(p,i)    (p[(i)>>3] & BIT_MASK_TABLE[(i)&7])
 
-const uint8_t BRANCH_TABLE1[] = {0U, 0U, 0U, 0U, 1U, 1U, 1U, 1U};
-const uint8_t BRANCH_TABLE2[] = {0U, 1U, 1U, 0U, 0U, 1U, 1U, 0U};
+// Branch metric towards each new state for the four received dibits, built
+// from the generator tables {0,0,0,0,1,1,1,1} and {0,1,1,0,0,1,1,0}. The odd
+// states use the complementary metric (M - metric).
+#if defined(_MSC_VER)
+__declspec(align(16))
+#endif
+const uint8_t BRANCH_METRICS[4U][16U]
+#if defined(__GNUC__)
+__attribute__((aligned(16)))
+#endif
+= {
+	{0U, 2U, 1U, 1U, 1U, 1U, 0U, 2U, 1U, 1U, 2U, 0U, 2U, 0U, 1U, 1U},
+	{1U, 1U, 0U, 2U, 0U, 2U, 1U, 1U, 2U, 0U, 1U, 1U, 1U, 1U, 2U, 0U},
+	{1U, 1U, 2U, 0U, 2U, 0U, 1U, 1U, 0U, 2U, 1U, 1U, 1U, 1U, 0U, 2U},
+	{2U, 0U, 1U, 1U, 1U, 1U, 2U, 0U, 1U, 1U, 0U, 2U, 0U, 2U, 1U, 1U}};
 
 const unsigned int NUM_OF_STATES_D2 = 8U;
 const unsigned int NUM_OF_STATES = 16U;
 const uint32_t     M = 2U;
 const unsigned int K = 5U;
 
+// The path metrics are kept modulo 256. Their spread is bounded by a few
+// branch metrics, so comparing them through a signed 8-bit difference gives
+// the same decisions as full width metrics, and all 16 states fit into one
+// 128-bit register.
+typedef uint16_t (*ACS_KERNEL)(const uint8_t* oldMetrics, uint8_t* newMetrics, uint8_t symbol);
+
+static uint16_t acsScalar(const uint8_t* oldMetrics, uint8_t* newMetrics, uint8_t symbol)
+{
+	const uint8_t* branch = BRANCH_METRICS[symbol];
+
+	uint16_t decisions = 0U;
+
+	for (unsigned int j = 0U; j < NUM_OF_STATES; j++) {
+		uint8_t m0 = oldMetrics[j >> 1] + branch[j];
+		uint8_t m1 = oldMetrics[(j >> 1) + NUM_OF_STATES_D2] + (M - branch[j]);
+
+		uint8_t decision = (int8_t(m0 - m1) >= 0) ? 1U : 0U;
+		newMetrics[j] = decision != 0U ? m1 : m0;
+
+		decisions |= uint16_t(decision) << j;
+	}
+
+	return decisions;
+}
+
+#if defined(USE_SSE2)
+static uint16_t acsSSE2(const uint8_t* oldMetrics, uint8_t* newMetrics, uint8_t symbol)
+{
+	__m128i metrics = _mm_loadu_si128((const __m128i*)oldMetrics);
+
+	// Predecessors i and i + 8 of states 2i and 2i + 1
+	__m128i lower = _mm_unpacklo_epi8(metrics, metrics);
+	__m128i upper = _mm_unpackhi_epi8(metrics, metrics);
+
+	__m128i branch  = _mm_load_si128((const __m128i*)BRANCH_METRICS[symbol]);
+	__m128i inverse = _mm_sub_epi8(_mm_set1_epi8(M), branch);
+
+	__m128i m0 = _mm_add_epi8(lower, branch);
+	__m128i m1 = _mm_add_epi8(upper, inverse);
+
+	// m0 < m1 selects the lower predecessor, otherwise the decision bit is set
+	__m128i less = _mm_cmplt_epi8(_mm_sub_epi8(m0, m1), _mm_setzero_si128());
+
+	_mm_storeu_si128((__m128i*)newMetrics, _mm_or_si128(_mm_and_si128(less, m0), _mm_andnot_si128(less, m1)));
+
+	return uint16_t(~_mm_movemask_epi8(less));
+}
+#endif
+
+#if defined(USE_NEON)
+static uint16_t acsNEON(const uint8_t* oldMetrics, uint8_t* newMetrics, uint8_t symbol)
+{
+	static const uint8_t BIT_WEIGHTS[] = {0x01U, 0x02U, 0x04U, 0x08U, 0x10U, 0x20U, 0x40U, 0x80U,
+					      0x01U, 0x02U, 0x04U, 0x08U, 0x10U, 0x20U, 0x40U, 0x80U};
+
+	uint8x16_t metrics = vld1q_u8(oldMetrics);
+
+	// Predecessors i and i + 8 of states 2i and 2i + 1
+#if defined(__aarch64__)
+	uint8x16_t lower = vzip1q_u8(metrics, metrics);
+	uint8x16_t upper = vzip2q_u8(metrics, metrics);
+#else
+	uint8x16x2_t zipped = vzipq_u8(metrics, metrics);
+	uint8x16_t lower = zipped.val[0];
+	uint8x16_t upper = zipped.val[1];
+#endif
+
+	uint8x16_t branch  = vld1q_u8(BRANCH_METRICS[symbol]);
+	uint8x16_t inverse = vsubq_u8(vdupq_n_u8(M), branch);
+
+	uint8x16_t m0 = vaddq_u8(lower, branch);
+	uint8x16_t m1 = vaddq_u8(upper, inverse);
+
+	// m0 < m1 selects the lower predecessor, otherwise the decision bit is set
+	uint8x16_t less = vcltq_s8(vreinterpretq_s8_u8(vsubq_u8(m0, m1)), vdupq_n_s8(0));
+
+	vst1q_u8(newMetrics, vbslq_u8(less, m0, m1));
+
+	uint8x16_t bits = vandq_u8(less, vld1q_u8(BIT_WEIGHTS));
+#if defined(__aarch64__)
+	uint16_t mask = uint16_t(vaddv_u8(vget_low_u8(bits))) | (uint16_t(vaddv_u8(vget_high_u8(bits))) << 8);
+#else
+	uint8x8_t sum = vpadd_u8(vget_low_u8(bits), vget_high_u8(bits));
+	sum = vpadd_u8(sum, sum);
+	sum = vpadd_u8(sum, sum);
+	uint16_t mask = uint16_t(vget_lane_u8(sum, 0)) | (uint16_t(vget_lane_u8(sum, 1)) << 8);
+#endif
+
+	return uint16_t(~mask);
+}
+#endif
+
+static ACS_KERNEL selectKernel()
+{
+#if defined(USE_SSE2)
+#if defined(__GNUC__)
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("sse2"))
+		return acsSSE2;
+#else
+	return acsSSE2;
+#endif
+#elif defined(USE_NEON)
+#if !defined(__aarch64__) && defined(__linux__)
+	if ((::getauxval(AT_HWCAP) & HWCAP_NEON) == HWCAP_NEON)
+		return acsNEON;
+#else
+	return acsNEON;
+#endif
+#endif
+
+	return acsScalar;
+}
+
+static const ACS_KERNEL ACS = selectKernel();
+
 CYSFConvolution::CYSFConvolution() :
-m_metrics1(NULL),
-m_metrics2(NULL),
 m_oldMetrics(NULL),
 m_newMetrics(NULL),
-m_decisions(NULL),
 m_dp(NULL)
 {
-	m_metrics1  = new uint16_t[16U];
-	m_metrics2  = new uint16_t[16U];
-	m_decisions = new uint64_t[180U];
 }
 
 CYSFConvolution::~CYSFConvolution()
 {
-	delete[] m_metrics1;
-	delete[] m_metrics2;
-	delete[] m_decisions;
 }
 
 void CYSFConvolution::start()
 {
-	::memset(m_metrics1, 0x00U, NUM_OF_STATES * sizeof(uint16_t));
-	::memset(m_metrics2, 0x00U, NUM_OF_STATES * sizeof(uint16_t));
+	::memset(m_metrics1, 0x00U, NUM_OF_STATES * sizeof(uint8_t));
+	::memset(m_metrics2, 0x00U, NUM_OF_STATES * sizeof(uint8_t));
 
 	m_oldMetrics = m_metrics1;
 	m_newMetrics = m_metrics2;
@@ -67,33 +199,63 @@ void CYSFConvolution::start()
 
 void CYSFConvolution::decode(uint8_t s0, uint8_t s1)
 {
-  *m_dp = 0U;
+	*m_dp++ = ACS(m_oldMetrics, m_newMetrics, ((s0 & 0x01U) << 1) | (s1 & 0x01U));
+
+	assert((m_dp - m_decisions) <= 180);
+
+	uint8_t* tmp = m_oldMetrics;
+	m_oldMetrics = m_newMetrics;
+	m_newMetrics = tmp;
+}
+
+void CYSFConvolution::decode(const uint8_t* symbols, unsigned int nSymbols)
+{
+	assert(symbols != NULL);
+	assert((m_dp - m_decisions) + nSymbols <= 180U);
+
+	ACS_KERNEL acs = ACS;
+
+	for (unsigned int i = 0U; i < nSymbols; i++) {
+		*m_dp++ = acs(m_oldMetrics, m_newMetrics, symbols[i] & 0x03U);
 
-  for (uint8_t i = 0U; i < NUM_OF_STATES_D2; i++) {
-    uint8_t j = i * 2U;
+		uint8_t* tmp = m_oldMetrics;
+		m_oldMetrics = m_newMetrics;
+		m_newMetrics = tmp;
+	}
+}
 
-    uint16_t metric = (BRANCH_TABLE1[i] ^ s0) + (BRANCH_TABLE2[i] ^ s1);
+void CYSFConvolution::decode(CYSFConvolution* convs, const uint8_t* const* symbols, unsigned int nSymbols, unsigned int count)
+{
+	assert(convs != NULL);
+	assert(symbols != NULL);
 
-    uint16_t m0 = m_oldMetrics[i] + metric;
-    uint16_t m1 = m_oldMetrics[i + NUM_OF_STATES_D2] + (M - metric);
-    uint8_t decision0 = (m0 >= m1) ? 1U : 0U;
-    m_newMetrics[j + 0U] = decision0 != 0U ? m1 : m0;
+	ACS_KERNEL acs = ACS;
 
-    m0 = m_oldMetrics[i] + (M - metric);
-    m1 = m_oldMetrics[i + NUM_OF_STATES_D2] + metric;
-    uint8_t decision1 = (m0 >= m1) ? 1U : 0U;
-    m_newMetrics[j + 1U] = decision1 != 0U ? m1 : m0;
+	// Interleave the trellises so that their add-compare-select chains overlap
+	for (unsigned int i = 0U; i < nSymbols; i++) {
+		for (unsigned int n = 0U; n < count; n++) {
+			CYSFConvolution& conv = convs[n];
 
-    *m_dp |= (uint64_t(decision1) << (j + 1U)) | (uint64_t(decision0) << (j + 0U));
-  }
+			*conv.m_dp++ = acs(conv.m_oldMetrics, conv.m_newMetrics, symbols[n][i] & 0x03U);
 
-  ++m_dp;
+			uint8_t* tmp = conv.m_oldMetrics;
+			conv.m_oldMetrics = conv.m_newMetrics;
+			conv.m_newMetrics = tmp;
+		}
+	}
+}
 
-  assert((m_dp - m_decisions) <= 180);
+const char* CYSFConvolution::getKernel()
+{
+#if defined(USE_SSE2)
+	if (ACS == acsSSE2)
+		return "SSE2";
+#elif defined(USE_NEON)
+	if (ACS == acsNEON)
+		return "NEON";
+#endif
 
-  uint16_t* tmp = m_oldMetrics;
-  m_oldMetrics = m_newMetrics;
-  m_newMetrics = tmp;
+	return "scalar";
 }
 
 void CYSFConvolution::chainback(unsigned char* out, unsigned int nBits)
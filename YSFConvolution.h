@@ -30,17 +30,24 @@ public:
 
 	void start();
 	void decode(uint8_t s0, uint8_t s1);
+	// Symbols are dibits packed as (s0 << 1) | s1
+	void decode(const uint8_t* symbols, unsigned int nSymbols);
 	void chainback(unsigned char* out, unsigned int nBits);
 
 	void encode(const unsigned char* in, unsigned char* out, unsigned int nBits) const;
 
+	// Run several independent trellises in lock step
+	static void decode(CYSFConvolution* convs, const uint8_t* const* symbols, unsigned int nSymbols, unsigned int count);
+
+	static const char* getKernel();
+
 private:
-	uint16_t* m_metrics1;
-	uint16_t* m_metrics2;
-	uint16_t* m_oldMetrics;
-	uint16_t* m_newMetrics;
-	uint64_t* m_decisions;
-	uint64_t* m_dp;
+	uint8_t   m_metrics1[16U];
+	uint8_t   m_metrics2[16U];
+	uint8_t*  m_oldMetrics;
+	uint8_t*  m_newMetrics;
+	uint16_t  m_decisions[180U];
+	uint16_t* m_dp;
 };
 
 #endif
@@ -70,39 +70,74 @@ bool CYSFFICH::decode(const unsigned char* bytes)
 {
 	assert(bytes != NULL);
 
-	// Skip the sync bytes
-	bytes += YSF_SYNC_LENGTH_BYTES;
+	bool valid = false;
+	decode(&bytes, this, &valid, 1U);
 
-	CYSFConvolution viterbi;
-	viterbi.start();
+	return valid;
+}
 
-	// Deinterleave the FICH and send bits to the Viterbi decoder
-	for (unsigned int i = 0U; i < 100U; i++) {
-		unsigned int n = INTERLEAVE_TABLE[i];
-		uint8_t s0 = READ_BIT1(bytes, n) ? 1U : 0U;
+void CYSFFICH::decode(const unsigned char* const* bytes, CYSFFICH* fich, bool* valid, unsigned int count)
+{
+	assert(bytes != NULL);
+	assert(fich != NULL);
+	assert(valid != NULL);
 
-		n++;
-		uint8_t s1 = READ_BIT1(bytes, n) ? 1U : 0U;
+	while (count > 0U) {
+		unsigned int n = count > YSF_FICH_BATCH ? YSF_FICH_BATCH : count;
 
-		viterbi.decode(s0, s1);
-	}
+		uint8_t symbols[YSF_FICH_BATCH][100U];
+		const uint8_t* pointers[YSF_FICH_BATCH];
 
-	unsigned char output[13U];
-	viterbi.chainback(output, 96U);
+		CYSFConvolution viterbi[YSF_FICH_BATCH];
 
-	unsigned int b0 = CGolay24128::decode24128(output + 0U);
-	unsigned int b1 = CGolay24128::decode24128(output + 3U);
-	unsigned int b2 = CGolay24128::decode24128(output + 6U);
-	unsigned int b3 = CGolay24128::decode24128(output + 9U);
+		for (unsigned int k = 0U; k < n; k++) {
+			assert(bytes[k] != NULL);
 
-	m_fich[0U] = (b0 >> 4) & 0xFFU;
-	m_fich[1U] = ((b0 << 4) & 0xF0U) | ((b1 >> 8) & 0x0FU);
-	m_fich[2U] = (b1 >> 0) & 0xFFU;
-	m_fich[3U] = (b2 >> 4) & 0xFFU;
-	m_fich[4U] = ((b2 << 4) & 0xF0U) | ((b3 >> 8) & 0x0FU);
-	m_fich[5U] = (b3 >> 0) & 0xFFU;
+			// Skip the sync bytes
+			const unsigned char* data = bytes[k] + YSF_SYNC_LENGTH_BYTES;
 
-	return CCRC::checkCCITT162(m_fich, 6U);
+			// Deinterleave the FICH into dibits for the Viterbi decoder
+			for (unsigned int i = 0U; i < 100U; i++) {
+				unsigned int m = INTERLEAVE_TABLE[i];
+				uint8_t s0 = READ_BIT1(data, m) ? 1U : 0U;
+
+				m++;
+				uint8_t s1 = READ_BIT1(data, m) ? 1U : 0U;
+
+				symbols[k][i] = (s0 << 1) | s1;
+			}
+
+			pointers[k] = symbols[k];
+			viterbi[k].start();
+		}
+
+		CYSFConvolution::decode(viterbi, pointers, 100U, n);
+
+		for (unsigned int k = 0U; k < n; k++) {
+			unsigned char output[13U];
+			viterbi[k].chainback(output, 96U);
+
+			unsigned int b0 = CGolay24128::decode24128(output + 0U);
+			unsigned int b1 = CGolay24128::decode24128(output + 3U);
+			unsigned int b2 = CGolay24128::decode24128(output + 6U);
+			unsigned int b3 = CGolay24128::decode24128(output + 9U);
+
+			unsigned char* out = fich[k].m_fich;
+			out[0U] = (b0 >> 4) & 0xFFU;
+			out[1U] = ((b0 << 4) & 0xF0U) | ((b1 >> 8) & 0x0FU);
+			out[2U] = (b1 >> 0) & 0xFFU;
+			out[3U] = (b2 >> 4) & 0xFFU;
+			out[4U] = ((b2 << 4) & 0xF0U) | ((b3 >> 8) & 0x0FU);
+			out[5U] = (b3 >> 0) & 0xFFU;
+
+			valid[k] = CCRC::checkCCITT162(out, 6U);
+		}
+
+		bytes += n;
+		fich  += n;
+		valid += n;
+		count -= n;
+	}
 }
 
 void CYSFFICH::encode(unsigned char* bytes)
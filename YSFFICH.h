@@ -20,6 +20,8 @@
 #if !defined(YSFFICH_H)
 #define  YSFFICH_H
 
+const unsigned int YSF_FICH_BATCH = 4U;
+
 class CYSFFICH {
 public:
 	CYSFFICH();
@@ -27,6 +29,9 @@ public:
 
 	bool decode(const unsigned char* bytes);
 
+	// Decode the FICH of several frames, sharing the Viterbi decoder passes
+	static void decode(const unsigned char* const* bytes, CYSFFICH* fich, bool* valid, unsigned int count);
+
 	void encode(unsigned char* bytes);
 
 	unsigned char getFI() const;
@@ -26,6 +26,15 @@
 
 const unsigned int BUFFER_LENGTH = 200U;
 
+CYSFClient::CYSFClient(const in_addr& address, unsigned int port, const unsigned char* callsign, unsigned int timeout) :
+m_address(address),
+m_port(port),
+m_callsign((const char*)callsign, YSF_CALLSIGN_LENGTH),
+m_timer(1000U, timeout)
+{
+	m_timer.start();
+}
+
 CYSFNetwork::CYSFNetwork(const std::string& address, unsigned int port, const std::string& callsign, bool debug) :
 m_socket(address, port),
 m_debug(debug),
@@ -33,8 +42,18 @@ m_address(),
 m_port(0U),
 m_poll(NULL),
 m_unlink(NULL),
-m_buffer(1000U, "YSF Network Buffer")
+m_buffer(1000U, "YSF Network Buffer"),
+m_reflector(false),
+m_timeout(60U),
+m_maxClients(50U),
+m_full(false),
+m_clients(),
+m_addresses(),
+m_ports(),
+m_mutex()
 {
+	m_buffer.setOverflow(RBO_DROP_OLDEST, RB_LENGTH_PREFIXED);
+
 	m_poll = new unsigned char[14U];
 	::memcpy(m_poll + 0U, "YSFP", 4U);
 
@@ -57,8 +76,18 @@ m_address(),
 m_port(0U),
 m_poll(NULL),
 m_unlink(NULL),
-m_buffer(1000U, "YSF Network Buffer")
+m_buffer(1000U, "YSF Network Buffer"),
+m_reflector(false),
+m_timeout(60U),
+m_maxClients(50U),
+m_full(false),
+m_clients(),
+m_addresses(),
+m_ports(),
+m_mutex()
 {
+	m_buffer.setOverflow(RBO_DROP_OLDEST, RB_LENGTH_PREFIXED);
+
 	m_poll = new unsigned char[14U];
 	::memcpy(m_poll + 0U, "YSFP", 4U);
 
@@ -76,6 +105,9 @@ m_buffer(1000U, "YSF Network Buffer")
 
 CYSFNetwork::~CYSFNetwork()
 {
+	for (std::vector<CYSFClient*>::iterator it = m_clients.begin(); it != m_clients.end(); ++it)
+		delete *it;
+
 	delete[] m_poll;
 }
 
@@ -103,16 +135,30 @@ void CYSFNetwork::clearDestination()
 	m_port           = 0U;
 }
 
+void CYSFNetwork::setReflectorMode(unsigned int timeout, unsigned int maxClients)
+{
+	clearDestination();
+
+	m_reflector  = true;
+	m_timeout    = timeout;
+	m_maxClients = maxClients;
+}
+
 bool CYSFNetwork::write(const unsigned char* data)
 {
 	assert(data != NULL);
 
-	if (m_port == 0U)
-		return true;
-
 	if (m_debug)
 		CUtils::dump(1U, "YSF Network Data Sent", data, 155U);
 
+	if (m_reflector) {
+		writeClients(data, NULL);
+		return true;
+	}
+
+	if (m_port == 0U)
+		return true;
+
 	return m_socket.write(data, 155U, m_address, m_port);
 }
 
@@ -134,27 +180,139 @@ bool CYSFNetwork::writeUnlink()
 
 void CYSFNetwork::clock(unsigned int ms)
 {
-	if (m_port == 0U)
+	if (m_reflector)
+		clockClients(ms);
+	else if (m_port == 0U)
 		return;
 
-	unsigned char buffer[BUFFER_LENGTH];
+	// The length goes in front of the data, so the whole frame is queued at once
+	unsigned char buffer[BUFFER_LENGTH + 1U];
 
-	in_addr address;
-	unsigned int port;
-	int length = m_socket.read(buffer, BUFFER_LENGTH, address, port);
-	if (length <= 0)
-		return;
+	for (;;) {
+		in_addr address;
+		unsigned int port;
+		int length = m_socket.read(buffer + 1U, BUFFER_LENGTH, address, port);
+		if (length <= 0)
+			return;
 
-	if (address.s_addr != m_address.s_addr || port != m_port)
-		return;
+		if (m_reflector) {
+			if (!processClient(buffer + 1U, length, address, port))
+				continue;
+		} else if (address.s_addr != m_address.s_addr || port != m_port) {
+			continue;
+		}
 
-	if (m_debug)
-		CUtils::dump(1U, "YSF Network Data Received", buffer, length);
+		if (m_debug)
+			CUtils::dump(1U, "YSF Network Data Received", buffer + 1U, length);
 
-	unsigned char len = length;
-	m_buffer.addData(&len, 1U);
+		buffer[0U] = length;
+
+		m_buffer.addData(buffer, length + 1U);
+	}
+}
+
+// Handles the client table, returns true for data to be passed on to DMR
+bool CYSFNetwork::processClient(const unsigned char* data, unsigned int length, const in_addr& address, unsigned int port)
+{
+	if (length < 14U)
+		return false;
+
+	m_mutex.lock();
+
+	CYSFClient* client = NULL;
+	std::vector<CYSFClient*>::iterator it;
+	for (it = m_clients.begin(); it != m_clients.end(); ++it) {
+		if ((*it)->m_address.s_addr == address.s_addr && (*it)->m_port == port) {
+			client = *it;
+			break;
+		}
+	}
+
+	if (::memcmp(data, "YSFP", 4U) == 0) {
+		if (client == NULL) {
+			// Every client is sent every frame, so a flood of polls must not add without limit
+			if (m_clients.size() >= m_maxClients) {
+				if (!m_full)
+					LogWarning("YSF client table full with %u clients, ignoring polls from %s:%u", m_maxClients, ::inet_ntoa(address), port);
+				m_full = true;
+				m_mutex.unlock();
+				return false;
+			}
+
+			client = new CYSFClient(address, port, data + 4U, m_timeout);
+			m_clients.push_back(client);
+			m_full = false;
+			LogMessage("YSF client %s has connected from %s:%u, %u clients", client->m_callsign.c_str(), ::inet_ntoa(address), port, (unsigned int)m_clients.size());
+		}
+
+		client->m_timer.start();
+		m_mutex.unlock();
+
+		m_socket.write(m_poll, 14U, address, port);
+		return false;
+	}
+
+	if (client == NULL) {
+		m_mutex.unlock();
+		return false;
+	}
+
+	if (::memcmp(data, "YSFU", 4U) == 0) {
+		LogMessage("YSF client %s has disconnected", client->m_callsign.c_str());
+		m_clients.erase(it);
+		delete client;
+		m_mutex.unlock();
+		return false;
+	}
+
+	m_mutex.unlock();
+
+	if (::memcmp(data, "YSFD", 4U) != 0 || length != 155U)
+		return false;
+
+	// As a reflector would, the other clients hear it as well
+	writeClients(data, client);
+
+	return true;
+}
+
+void CYSFNetwork::writeClients(const unsigned char* data, const CYSFClient* except)
+{
+	m_mutex.lock();
+
+	m_addresses.clear();
+	m_ports.clear();
+
+	for (std::vector<CYSFClient*>::const_iterator it = m_clients.begin(); it != m_clients.end(); ++it) {
+		if (*it != except) {
+			m_addresses.push_back((*it)->m_address);
+			m_ports.push_back((*it)->m_port);
+		}
+	}
+
+	if (!m_addresses.empty())
+		m_socket.write(data, 155U, &m_addresses[0U], &m_ports[0U], (unsigned int)m_addresses.size());
+
+	m_mutex.unlock();
+}
+
+void CYSFNetwork::clockClients(unsigned int ms)
+{
+	m_mutex.lock();
+
+	for (std::vector<CYSFClient*>::iterator it = m_clients.begin(); it != m_clients.end();) {
+		(*it)->m_timer.clock(ms);
+
+		if ((*it)->m_timer.hasExpired()) {
+			LogMessage("YSF client %s has timed out", (*it)->m_callsign.c_str());
+			delete *it;
+			it = m_clients.erase(it);
+		} else {
+			++it;
+		}
+	}
 
-	m_buffer.addData(buffer, length);
+	m_mutex.unlock();
 }
 
 unsigned int CYSFNetwork::read(unsigned char* data)
@@ -22,9 +22,23 @@
 #include "YSFDefines.h"
 #include "UDPSocket.h"
 #include "RingBuffer.h"
+#include "Mutex.h"
+#include "Timer.h"
 
 #include <cstdint>
 #include <string>
+#include <vector>
+
+// A YSF client served directly in reflector mode
+class CYSFClient {
+public:
+	CYSFClient(const in_addr& address, unsigned int port, const unsigned char* callsign, unsigned int timeout);
+
+	in_addr      m_address;
+	unsigned int m_port;
+	std::string  m_callsign;
+	CTimer       m_timer;
+};
 
 class CYSFNetwork {
 public:
@@ -39,6 +53,10 @@ public:
 	void setDestination(const in_addr& address, unsigned int port);
 	void clearDestination();
 
+	// Serve polling YSF clients instead of talking to one destination, new
+	// clients beyond maxClients are ignored
+	void setReflectorMode(unsigned int timeout, unsigned int maxClients);
+
 	bool write(const unsigned char* data);
 
 	bool writePoll();
@@ -59,6 +77,18 @@ private:
 	unsigned char*             m_poll;
 	unsigned char*             m_unlink;
 	CRingBuffer<unsigned char> m_buffer;
+	bool                       m_reflector;
+	unsigned int               m_timeout;
+	unsigned int               m_maxClients;
+	bool                       m_full;		// A client has been turned away since the last one was added
+	std::vector<CYSFClient*>   m_clients;
+	std::vector<in_addr>       m_addresses;
+	std::vector<unsigned int>  m_ports;
+	CMutex                     m_mutex;
+
+	bool processClient(const unsigned char* data, unsigned int length, const in_addr& address, unsigned int port);
+	void writeClients(const unsigned char* data, const CYSFClient* except);
+	void clockClients(unsigned int ms);
 };
 
 #endif
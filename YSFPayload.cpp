@@ -99,32 +99,10 @@ bool CYSFPayload::processHeaderData(unsigned char* data)
 
 	data += YSF_SYNC_LENGTH_BYTES + YSF_FICH_LENGTH_BYTES;
 
-	unsigned char dch[45U];
-
-	unsigned char* p1 = data;
-	unsigned char* p2 = dch;
-	for (unsigned int i = 0U; i < 5U; i++) {
-		::memcpy(p2, p1, 9U);
-		p1 += 18U; p2 += 9U;
-	}
-
 	CYSFConvolution conv;
-	conv.start();
-
-	for (unsigned int i = 0U; i < 180U; i++) {
-		unsigned int n = INTERLEAVE_TABLE_9_20[i];
-		uint8_t s0 = READ_BIT1(dch, n) ? 1U : 0U;
-
-		n++;
-		uint8_t s1 = READ_BIT1(dch, n) ? 1U : 0U;
-
-		conv.decode(s0, s1);
-	}
 
 	unsigned char output[23U];
-	conv.chainback(output, 176U);
-
-	bool valid1 = CCRC::checkCCITT162(output, 22U);
+	bool valid1 = decodeCSD(data, output);
 	if (valid1) {
 		for (unsigned int i = 0U; i < 20U; i++)
 			output[i] ^= WHITENING_DATA[i];
@@ -165,36 +143,15 @@ bool CYSFPayload::processHeaderData(unsigned char* data)
 			WRITE_BIT1(bytes, n, s1);
 		}
 
-		p1 = data;
-		p2 = bytes;
+		unsigned char* p1 = data;
+		unsigned char* p2 = bytes;
 		for (unsigned int i = 0U; i < 5U; i++) {
 			::memcpy(p1, p2, 9U);
 			p1 += 18U; p2 += 9U;
 		}
 	}
 
-	p1 = data + 9U;
-	p2 = dch;
-	for (unsigned int i = 0U; i < 5U; i++) {
-		::memcpy(p2, p1, 9U);
-		p1 += 18U; p2 += 9U;
-	}
-
-	conv.start();
-
-	for (unsigned int i = 0U; i < 180U; i++) {
-		unsigned int n = INTERLEAVE_TABLE_9_20[i];
-		uint8_t s0 = READ_BIT1(dch, n) ? 1U : 0U;
-
-		n++;
-		uint8_t s1 = READ_BIT1(dch, n) ? 1U : 0U;
-
-		conv.decode(s0, s1);
-	}
-
-	conv.chainback(output, 176U);
-
-	bool valid2 = CCRC::checkCCITT162(output, 22U);
+	bool valid2 = decodeCSD(data + 9U, output);
 	if (valid2) {
 		for (unsigned int i = 0U; i < 20U; i++)
 			output[i] ^= WHITENING_DATA[i];
@@ -231,8 +188,8 @@ bool CYSFPayload::processHeaderData(unsigned char* data)
 			WRITE_BIT1(bytes, n, s1);
 		}
 
-		p1 = data + 9U;
-		p2 = bytes;
+		unsigned char* p1 = data + 9U;
+		unsigned char* p2 = bytes;
 		for (unsigned int i = 0U; i < 5U; i++) {
 			::memcpy(p1, p2, 9U);
 			p1 += 18U; p2 += 9U;
@@ -242,6 +199,67 @@ bool CYSFPayload::processHeaderData(unsigned char* data)
 	return valid1;
 }
 
+bool CYSFPayload::readHeaderData(const unsigned char* data, char* dest, char* source)
+{
+	assert(data != NULL);
+	assert(dest != NULL);
+	assert(source != NULL);
+
+	data += YSF_SYNC_LENGTH_BYTES + YSF_FICH_LENGTH_BYTES;
+
+	unsigned char output[23U];
+	if (!decodeCSD(data, output))
+		return false;
+
+	for (unsigned int i = 0U; i < 20U; i++)
+		output[i] ^= WHITENING_DATA[i];
+
+	::memcpy(dest, output + 0U, YSF_CALLSIGN_LENGTH);
+	dest[YSF_CALLSIGN_LENGTH] = 0x00;
+
+	::memcpy(source, output + YSF_CALLSIGN_LENGTH, YSF_CALLSIGN_LENGTH);
+	source[YSF_CALLSIGN_LENGTH] = 0x00;
+
+	return true;
+}
+
+// De-interleaves and decodes one of CSD1 or CSD2, returning whether its CRC
+// is good. The output is 23 bytes and is left whitened.
+bool CYSFPayload::decodeCSD(const unsigned char* data, unsigned char* output)
+{
+	assert(data != NULL);
+	assert(output != NULL);
+
+	unsigned char dch[45U];
+
+	const unsigned char* p1 = data;
+	unsigned char* p2 = dch;
+	for (unsigned int i = 0U; i < 5U; i++) {
+		::memcpy(p2, p1, 9U);
+		p1 += 18U; p2 += 9U;
+	}
+
+	CYSFConvolution conv;
+	conv.start();
+
+	uint8_t symbols[180U];
+	for (unsigned int i = 0U; i < 180U; i++) {
+		unsigned int n = INTERLEAVE_TABLE_9_20[i];
+		uint8_t s0 = READ_BIT1(dch, n) ? 1U : 0U;
+
+		n++;
+		uint8_t s1 = READ_BIT1(dch, n) ? 1U : 0U;
+
+		symbols[i] = (s0 << 1) | s1;
+	}
+
+	conv.decode(symbols, 180U);
+
+	conv.chainback(output, 176U);
+
+	return CCRC::checkCCITT162(output, 22U);
+}
+
 bool CYSFPayload::readDataFRModeData1(const unsigned char* data, unsigned char* dt)
 {
 	assert(data != NULL);
@@ -263,6 +281,7 @@ bool CYSFPayload::readDataFRModeData1(const unsigned char* data, unsigned char*
 	CYSFConvolution conv;
 	conv.start();
 
+	uint8_t symbols[180U];
 	for (unsigned int i = 0U; i < 180U; i++) {
 		unsigned int n = INTERLEAVE_TABLE_9_20[i];
 		uint8_t s0 = READ_BIT1(dch, n) ? 1U : 0U;
@@ -270,9 +289,11 @@ bool CYSFPayload::readDataFRModeData1(const unsigned char* data, unsigned char*
 		n++;
 		uint8_t s1 = READ_BIT1(dch, n) ? 1U : 0U;
 
-		conv.decode(s0, s1);
+		symbols[i] = (s0 << 1) | s1;
 	}
 
+	conv.decode(symbols, 180U);
+
 	unsigned char output[23U];
 	conv.chainback(output, 176U);
 
@@ -310,6 +331,7 @@ bool CYSFPayload::readDataFRModeData2(const unsigned char* data, unsigned char*
 	CYSFConvolution conv;
 	conv.start();
 
+	uint8_t symbols[180U];
 	for (unsigned int i = 0U; i < 180U; i++) {
 		unsigned int n = INTERLEAVE_TABLE_9_20[i];
 		uint8_t s0 = READ_BIT1(dch, n) ? 1U : 0U;
@@ -317,9 +339,11 @@ bool CYSFPayload::readDataFRModeData2(const unsigned char* data, unsigned char*
 		n++;
 		uint8_t s1 = READ_BIT1(dch, n) ? 1U : 0U;
 
-		conv.decode(s0, s1);
+		symbols[i] = (s0 << 1) | s1;
 	}
 
+	conv.decode(symbols, 180U);
+
 	unsigned char output[23U];
 	conv.chainback(output, 176U);
 
@@ -399,6 +423,7 @@ bool CYSFPayload::readVDMode1Data(const unsigned char* data, unsigned char* dt)
 	CYSFConvolution conv;
 	conv.start();
 
+	uint8_t symbols[180U];
 	for (unsigned int i = 0U; i < 180U; i++) {
 		unsigned int n = INTERLEAVE_TABLE_9_20[i];
 		uint8_t s0 = READ_BIT1(dch, n) ? 1U : 0U;
@@ -406,9 +431,11 @@ bool CYSFPayload::readVDMode1Data(const unsigned char* data, unsigned char* dt)
 		n++;
 		uint8_t s1 = READ_BIT1(dch, n) ? 1U : 0U;
 
-		conv.decode(s0, s1);
+		symbols[i] = (s0 << 1) | s1;
 	}
 
+	conv.decode(symbols, 180U);
+
 	unsigned char output[23U];
 	conv.chainback(output, 176U);
 
@@ -445,6 +472,7 @@ bool CYSFPayload::readVDMode2Data(const unsigned char* data, unsigned char* dt)
 	CYSFConvolution conv;
 	conv.start();
 
+	uint8_t symbols[100U];
 	for (unsigned int i = 0U; i < 100U; i++) {
 		unsigned int n = INTERLEAVE_TABLE_5_20[i];
 		uint8_t s0 = READ_BIT1(dch, n) ? 1U : 0U;
@@ -452,9 +480,11 @@ bool CYSFPayload::readVDMode2Data(const unsigned char* data, unsigned char* dt)
 		n++;
 		uint8_t s1 = READ_BIT1(dch, n) ? 1U : 0U;
 
-		conv.decode(s0, s1);
+		symbols[i] = (s0 << 1) | s1;
 	}
 
+	conv.decode(symbols, 100U);
+
 	unsigned char output[13U];
 	conv.chainback(output, 96U);
 
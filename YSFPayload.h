@@ -28,6 +28,10 @@ public:
 
 	bool processHeaderData(unsigned char* bytes);
 
+	// Only CSD1 is decoded, and nothing is written back. The callsigns
+	// are YSF_CALLSIGN_LENGTH + 1 bytes each, with a NUL added.
+	static bool readHeaderData(const unsigned char* bytes, char* dest, char* source);
+
 	void writeVDMode2Data(unsigned char* data, const unsigned char* dt);
 	bool readVDMode1Data(const unsigned char* data, unsigned char* dt);
 	bool readVDMode2Data(const unsigned char* data, unsigned char* dt);
@@ -52,6 +56,8 @@ private:
 	unsigned char* m_downlink;
 	unsigned char* m_source;
 	unsigned char* m_dest;
+
+	static bool decodeCSD(const unsigned char* data, unsigned char* output);
 };
 
 #endif